@@ -0,0 +1,249 @@
+// sweeps generated workloads of growing size through Plan::schedule and reports model build time, solve time,
+// peak RSS and objective per instance. the seeds are fixed, so two runs (or two builds) see the same instances;
+// "make benchmark-build-mode" compares the model building of the checked and the fast build this way, and
+// "make benchmark-candidates" the uniform and the boundary candidates.
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <fmt/format.h>
+#include <fmt/ranges.h>
+#include <nlohmann/json.hpp>
+#include "plan.hpp"
+#include "workload.hpp"
+
+struct bench_arguments {
+    std::vector<unsigned> student_counts{10, 25, 50, 100, 200};
+    std::vector<double> overlap_densities{0.2, 0.8};
+    unsigned seeds{3};
+    double day_clustering{0.5};
+    unsigned max_windows{3};
+    double time_limit{30};
+    unsigned time_granularity{default_time_granularity};
+    unsigned coarse_granularity{0};
+    // every instance is solved with each of them
+    std::vector<ModelEncoding> model_encodings{ModelEncoding::BOOLEAN};
+    std::vector<CandidateMode> candidate_modes{CandidateMode::UNIFORM};
+    bool json{false};
+    std::string output{"benchmark.csv"};
+    const char *dump_dir{nullptr};
+};
+
+template <typename T>
+static std::vector<T> parse_list(const char* str) {
+    std::vector<T> values;
+    std::istringstream stream(str);
+    for (std::string item; std::getline(stream, item, ',');)
+        values.push_back(T(std::stod(item)));
+    return values;
+}
+
+// peak resident set size of the whole process so far in KiB; the sweep runs from small to large, so this is the
+// peak of the largest instance up to now
+static long peak_rss_kib() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+// same format as the input of student-planner
+static nlohmann::json export_workload(const std::vector<workload_student>& workload) {
+    nlohmann::json students = nlohmann::json::array();
+    for (const auto& student : workload) {
+        nlohmann::json availabilities = nlohmann::json::array();
+        for (const auto& [from, to] : student.availabilities)
+            availabilities.push_back({
+                {"day", fmt::format("{:d}", from)},
+                {"from_hour", from.get_hour()},
+                {"from_minute", from.get_minute()},
+                {"to_hour", to.get_hour()},
+                {"to_minute", to.get_minute()},
+            });
+        students.push_back({
+            {"id", student.id},
+            {"name", student.name},
+            {"lesson_duration", student.lesson_duration},
+            {"availabilities", availabilities},
+        });
+    }
+    return students;
+}
+
+int main(int argc, char* const* argv) {
+    bench_arguments args;
+    bool output_set{false};
+    int c;
+    while ((c = getopt(argc, argv, "n:p:s:c:w:t:G:F:b:a:jo:d:h")) != -1)
+        switch (c) {
+            case 'n': args.student_counts = parse_list<unsigned>(optarg); break;
+            case 'p': args.overlap_densities = parse_list<double>(optarg); break;
+            case 's': args.seeds = atoi(optarg); break;
+            case 'c': args.day_clustering = atof(optarg); break;
+            case 'w': args.max_windows = atoi(optarg); break;
+            case 't': args.time_limit = atof(optarg); break;
+            case 'G': args.time_granularity = validate_time_granularity(atoi(optarg)); break;
+            case 'F': args.coarse_granularity = atoi(optarg); break;
+            case 'b': {
+                args.model_encodings.clear();
+                std::istringstream stream(optarg);
+                for (std::string item; std::getline(stream, item, ',');)
+                    args.model_encodings.push_back(parse_model_encoding(item));
+                break;
+            }
+            case 'a': {
+                args.candidate_modes.clear();
+                std::istringstream stream(optarg);
+                for (std::string item; std::getline(stream, item, ',');)
+                    args.candidate_modes.push_back(parse_candidate_mode(item));
+                break;
+            }
+            case 'j': args.json = true; break;
+            case 'o': args.output = optarg; output_set = true; break;
+            case 'd': args.dump_dir = optarg; break;
+            default:
+                fmt::println("usage: {} "
+                             "[-n <student-counts,...>] "
+                             "[-p <overlap-densities,...>] "
+                             "[-s <seeds-per-size>] "
+                             "[-c <day-clustering>] "
+                             "[-w <max-windows>] "
+                             "[-t <time-limit-seconds>] "
+                             "[-G <granularity-minutes>] "
+                             "[-F <coarse-granularity-minutes>] "
+                             "[-b <boolean|interval,...>] "
+                             "[-a <uniform|boundary,...>] "
+                             "[-j] "
+                             "[-o <output-file|->] "
+                             "[-d <dump-dir>]", argv[0]);
+                return c == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    validate_coarse_granularity(args.coarse_granularity, args.time_granularity);
+    if (args.json && !output_set)
+        args.output = "benchmark.json";
+
+    // the planner prints its progress to stdout, so the results go to a file unless asked otherwise
+    std::ofstream output_file;
+    if (args.output != "-")
+        output_file.open(args.output);
+    std::ostream& output = args.output != "-" ? output_file : std::cout;
+
+    const std::vector<std::string> columns = {
+        "build_mode", "students", "overlap_density", "day_clustering", "seed", "granularity", "coarse_granularity", "model", "candidates", "status", "objective", "best_bound", "gap",
+        "variables", "constraints", "model_bytes", "symmetry_classes", "build_wall", "build_cpu", "solve_wall", "solve_cpu", "total_wall", "peak_rss_kib",
+    };
+    nlohmann::json json_rows = nlohmann::json::array();
+    if (!args.json)
+        output << fmt::format("{}", fmt::join(columns, ",")) << std::endl;
+
+    for (const auto student_count : args.student_counts) {
+        for (const auto overlap_density : args.overlap_densities) {
+            for (unsigned seed = 1; seed <= args.seeds; ++seed) {
+                const workload_config workload_cfg{
+                    .student_count = student_count,
+                    .max_windows = args.max_windows,
+                    .day_clustering = args.day_clustering,
+                    .overlap_density = overlap_density,
+                    .seed = seed,
+                };
+                const auto workload = generate_workload(workload_cfg);
+                if (args.dump_dir) {
+                    std::ofstream dump(fmt::format("{}/workload_{}_{:.2f}_{}.json", args.dump_dir, student_count, overlap_density, seed));
+                    dump << export_workload(workload).dump(4) << std::endl;
+                }
+
+                for (const auto model_encoding : args.model_encodings) {
+                    for (const auto candidate_mode : args.candidate_modes) {
+                        Plan plan(to_students(workload));
+                        const struct solve_config cfg = {
+                            .range_attempts = default_range_attempts,
+                            .range_increment = default_range_increment,
+                            .candidate_mode = candidate_mode,
+                            .minimize_wishes_prio = true,
+                            .minimize_holes = true,
+                            .lunch_time_from_hour = 12,
+                            .lunch_time_from_minute = 0,
+                            .lunch_time_to_hour = 13,
+                            .lunch_time_to_minute = 0,
+                            .lunch_hole_neg_prio = 10,
+                            .non_lunch_hole_prio = 150,
+                            // random workloads are not always feasible
+                            .allow_skip = true,
+                            .skip_prio = 1000000,
+                            .conflict_encoding = ConflictEncoding::AT_MOST_ONE,
+                            .hole_encoding = HoleEncoding::CHAIN,
+                            .max_time_in_seconds = args.time_limit,
+                            .relative_gap_limit = 0,
+                            .repair_hint = false,
+                            .decompose = true,
+                            .num_workers = 0,
+                            .precheck = true,
+                            .break_symmetry = true,
+                            .solve_mode = SolveMode::EXACT,
+                            .objective_order = {},
+                            .time_granularity = args.time_granularity,
+                            .coarse_granularity = args.coarse_granularity,
+                            .model_encoding = model_encoding,
+                            .alternatives = 0,
+                            .alternative_distance = 1,
+                        };
+                        const bool success = plan.schedule(cfg);
+
+                        const auto& statistics = plan.get_statistics();
+                        phase_time build;
+                        for (const auto phase : {Phase::PRECHECK, Phase::VARIABLES, Phase::CONFLICTS, Phase::HOLES})
+                            build += statistics[phase];
+                        int64_t constraints{};
+                        for (const auto count : statistics.constraints)
+                            constraints += count;
+
+                        const nlohmann::json row = {
+                            {"build_mode", build_mode::name},
+                            {"students", student_count},
+                            {"overlap_density", overlap_density},
+                            {"day_clustering", args.day_clustering},
+                            {"seed", seed},
+                            {"granularity", args.time_granularity},
+                            {"coarse_granularity", args.coarse_granularity},
+                            {"model", model_encoding_names.at(unsigned(model_encoding))},
+                            {"candidates", candidate_mode_names.at(unsigned(candidate_mode))},
+                            {"status", plan.get_status_name()},
+                            {"objective", success ? nlohmann::json(plan.get_objective_value()) : nlohmann::json()},
+                            {"best_bound", statistics.best_objective_bound},
+                            {"gap", statistics.gap},
+                            {"variables", statistics.variables},
+                            {"constraints", constraints},
+                            {"model_bytes", statistics.model_bytes},
+                            {"symmetry_classes", statistics.symmetry_classes},
+                            {"build_wall", build.wall},
+                            {"build_cpu", build.cpu},
+                            {"solve_wall", statistics[Phase::SOLVE].wall},
+                            {"solve_cpu", statistics[Phase::SOLVE].cpu},
+                            {"total_wall", statistics[Phase::TOTAL].wall},
+                            {"peak_rss_kib", peak_rss_kib()},
+                        };
+
+                        if (args.json) {
+                            json_rows.push_back(row);
+                        } else {
+                            std::vector<std::string> fields;
+                            for (const auto& column : columns) {
+                                const auto& value = row.at(column);
+                                fields.push_back(value.is_string() ? value.get<std::string>() : value.is_null() ? "" : value.dump());
+                            }
+                            output << fmt::format("{}", fmt::join(fields, ",")) << std::endl;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    if (args.json)
+        output << json_rows.dump(4) << std::endl;
+
+    return EXIT_SUCCESS;
+}
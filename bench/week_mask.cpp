@@ -0,0 +1,115 @@
+// microbenchmark: overlap detection between all pairs of students with the per-chunk candidate lists
+// used by Student::register_conflicts versus one WeekMask per student.
+#include <chrono>
+#include <list>
+#include <random>
+#include <tuple>
+#include <vector>
+#include <fmt/format.h>
+#include "time.hpp"
+#include "week_mask.hpp"
+
+struct bench_student {
+    unsigned lesson_chunks;
+    std::vector<std::pair<Time, Time>> ranges;
+};
+
+static std::vector<bench_student> generate(unsigned student_count, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::vector<bench_student> students(student_count);
+    for (auto& student : students) {
+        student.lesson_chunks = 30 / MIN_ALIGNMENT + rng() % 4 * (15 / MIN_ALIGNMENT + 1);
+        const unsigned windows = 1 + rng() % 3;
+        for (unsigned w{}; w < windows; ++w) {
+            const auto day = Day(rng() % 5);
+            const unsigned from_hour = 8 + rng() % 10;
+            const unsigned length_hours = 1 + rng() % 4;
+            student.ranges.emplace_back(Time(day, from_hour, 0), Time(day, std::min(23u, from_hour + length_hours), 0));
+        }
+    }
+    return students;
+}
+
+template <typename F>
+static double measure(unsigned repetitions, F&& f) {
+    const auto begin = std::chrono::steady_clock::now();
+    for (unsigned i{}; i < repetitions; ++i)
+        f();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(end - begin).count() / repetitions;
+}
+
+int main() {
+#ifdef __AVX2__
+    fmt::println("kernels: AVX2");
+#else
+    fmt::println("kernels: scalar");
+#endif
+    fmt::println("{:>8} {:>14} {:>14} {:>14} {:>10}", "students", "lists [us]", "masks [us]", "build [us]", "overlaps");
+
+    for (const unsigned student_count : {25u, 50u, 100u, 200u, 400u}) {
+        const auto students = generate(student_count, 42);
+        const unsigned repetitions = 20000 / student_count + 1;
+
+        // the current representation: per chunk a list of (candidate, prio), scanned for every covered chunk
+        size_t list_overlaps{};
+        const double list_time = measure(repetitions, [&] {
+            std::vector<std::list<std::tuple<unsigned, unsigned>>> wishes(slots_per_week);
+            for (unsigned index{}; index < students.size(); ++index)
+                for (const auto& [start, end] : students[index].ranges)
+                    for (auto t = start; t + students[index].lesson_chunks <= end; t += 1)
+                        for (unsigned chunk{}; chunk < students[index].lesson_chunks; ++chunk)
+                            wishes[t.get_chunk_of_week() + chunk].emplace_back(index, 0);
+
+            std::vector<std::vector<bool>> overlap(students.size(), std::vector<bool>(students.size()));
+            for (const auto& l : wishes)
+                for (const auto& [a, _a] : l)
+                    for (const auto& [b, _b] : l)
+                        if (a < b)
+                            overlap[a][b] = true;
+
+            list_overlaps = 0;
+            for (const auto& row : overlap)
+                for (const bool o : row)
+                    list_overlaps += o;
+        });
+
+        std::vector<WeekMask> masks(students.size());
+        const double build_time = measure(repetitions, [&] {
+            for (unsigned index{}; index < students.size(); ++index) {
+                masks[index] = WeekMask();
+                for (const auto& [start, end] : students[index].ranges)
+                    if (start + students[index].lesson_chunks <= end)
+                        masks[index].set_range(start, end);
+            }
+        });
+
+        size_t mask_overlaps{};
+        const double mask_time = measure(repetitions, [&] {
+            mask_overlaps = 0;
+            for (unsigned a{}; a < masks.size(); ++a)
+                for (unsigned b = a + 1; b < masks.size(); ++b)
+                    mask_overlaps += masks[a].intersects(masks[b]);
+        });
+
+        if (list_overlaps != mask_overlaps)
+            fmt::println(stderr, "mismatch: {} overlaps from lists, {} from masks", list_overlaps, mask_overlaps);
+
+        fmt::println("{:>8} {:>14.1f} {:>14.1f} {:>14.1f} {:>10}", student_count, list_time, mask_time, build_time, mask_overlaps);
+    }
+
+    // raw kernel throughput
+    const auto students = generate(2, 7);
+    WeekMask a, b;
+    for (const auto& [start, end] : students[0].ranges)
+        a.set_range(start, end);
+    for (const auto& [start, end] : students[1].ranges)
+        b.set_range(start, end);
+    volatile unsigned sink{};
+    const unsigned repetitions = 1000000;
+    fmt::println("and+count: {:.1f} ns", 1000 * measure(repetitions, [&] { sink = sink + (a & b).count(); }));
+    fmt::println("or+count:  {:.1f} ns", 1000 * measure(repetitions, [&] { sink = sink + (a | b).count(); }));
+    fmt::println("intersects: {:.1f} ns", 1000 * measure(repetitions, [&] { sink = sink + a.intersects(b); }));
+
+    return EXIT_SUCCESS;
+}
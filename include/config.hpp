@@ -1,16 +1,172 @@
 #pragma once
+#include <algorithm>
+#include <array>
+#include <string>
+#include <stdexcept>
+#include <vector>
+#include <fmt/format.h>
 
-#define DEBUG
+// what a build spends on diagnostics. builds with NDEBUG (the release builds of the Makefile and setup.py) are
+// "fast_build", all others "checked_build".
+struct checked_build {
+    static constexpr const char* name = "checked";
+    static constexpr bool checked_access = true;  // AT() checks the bounds
+    static constexpr bool named_variables = true; // the model variables get readable names
+    static constexpr bool trace = true;           // the hole model and the used cells of the solution are printed
+};
+
+struct fast_build {
+    static constexpr const char* name = "fast";
+    static constexpr bool checked_access = false;
+    static constexpr bool named_variables = false;
+    static constexpr bool trace = false;
+};
 
-#ifdef DEBUG
-#define AT(vec, entry) vec.at(entry)
+#ifdef NDEBUG
+using build_mode = fast_build;
 #else
-#define AT(vec, entry) vec[entry]
+using build_mode = checked_build;
 #endif
 
+template <typename Container, typename Index>
+constexpr decltype(auto) checked_at(Container&& container, Index index) {
+    if constexpr (build_mode::checked_access)
+        return container.at(index);
+    else
+        return container[index];
+}
+
+#define AT(vec, entry) checked_at(vec, entry)
+
+enum class ConflictEncoding : unsigned {
+    PAIRWISE,    // one implication per pair of overlapping candidates
+    AT_MOST_ONE, // one at-most-one per (non-dominated) chunk of the week
+};
+
+static const std::array<std::string, 2> conflict_encoding_names = {
+    "pairwise",
+    "at-most-one",
+};
+
+inline ConflictEncoding parse_conflict_encoding(const std::string& str) {
+    for (unsigned i{}; i < conflict_encoding_names.size(); ++i)
+        if (str == conflict_encoding_names[i])
+            return ConflictEncoding(i);
+    throw std::runtime_error(fmt::format("invalid conflict encoding '{}'", str));
+}
+
+enum class HoleEncoding : unsigned {
+    PREFIX, // usage before/after as disjunction over the rest of the day
+    CHAIN,  // usage before/after chained from the neighbouring chunk
+};
+
+static const std::array<std::string, 2> hole_encoding_names = {
+    "prefix",
+    "chain",
+};
+
+inline HoleEncoding parse_hole_encoding(const std::string& str) {
+    for (unsigned i{}; i < hole_encoding_names.size(); ++i)
+        if (str == hole_encoding_names[i])
+            return HoleEncoding(i);
+    throw std::runtime_error(fmt::format("invalid hole encoding '{}'", str));
+}
+
+enum class ModelEncoding : unsigned {
+    BOOLEAN,  // one literal per candidate start
+    INTERVAL, // one optional interval per availability range, its start an integer variable
+};
+
+static const std::array<std::string, 2> model_encoding_names = {
+    "boolean",
+    "interval",
+};
+
+inline ModelEncoding parse_model_encoding(const std::string& str) {
+    for (unsigned i{}; i < model_encoding_names.size(); ++i)
+        if (str == model_encoding_names[i])
+            return ModelEncoding(i);
+    throw std::runtime_error(fmt::format("invalid model encoding '{}'", str));
+}
+
+enum class CandidateMode : unsigned {
+    UNIFORM,  // every "range_increment"-th cell boundary of a range, at most "range_attempts" of them
+    BOUNDARY, // the cell boundaries a lesson of a hole-free packing can start at, see "Plan::find_anchors"
+};
+
+static const std::array<std::string, 2> candidate_mode_names = {
+    "uniform",
+    "boundary",
+};
+
+inline CandidateMode parse_candidate_mode(const std::string& str) {
+    for (unsigned i{}; i < candidate_mode_names.size(); ++i)
+        if (str == candidate_mode_names[i])
+            return CandidateMode(i);
+    throw std::runtime_error(fmt::format("invalid candidate mode '{}'", str));
+}
+
+enum class SolveMode : unsigned {
+    EXACT,                // CP-SAT only
+    HEURISTIC,            // greedy placement and local search only
+    HEURISTIC_THEN_EXACT, // CP-SAT, hinted with (and falling back to) the heuristic schedule
+    LNS,                  // like HEURISTIC_THEN_EXACT, but improving the first schedule by re-solving neighbourhoods
+};
+
+static const std::array<std::string, 4> solve_mode_names = {
+    "exact",
+    "heuristic",
+    "heuristic-then-exact",
+    "lns",
+};
+
+inline SolveMode parse_solve_mode(const std::string& str) {
+    for (unsigned i{}; i < solve_mode_names.size(); ++i)
+        if (str == solve_mode_names[i])
+            return SolveMode(i);
+    throw std::runtime_error(fmt::format("invalid solve mode '{}'", str));
+}
+
+// the parts of the objective, for solving them one after the other
+enum class Objective : unsigned {
+    SKIPS,  // number of skipped students
+    WISHES, // wish priorities of the chosen candidates
+    HOLES,  // weights of the holes between lessons
+};
+
+static const std::array<std::string, 3> objective_names = {
+    "skips",
+    "wishes",
+    "holes",
+};
+
+inline Objective parse_objective(const std::string& str) {
+    for (unsigned i{}; i < objective_names.size(); ++i)
+        if (str == objective_names[i])
+            return Objective(i);
+    throw std::runtime_error(fmt::format("invalid objective '{}'", str));
+}
+
+// comma separated, e.g. "skips,wishes,holes"
+inline std::vector<Objective> parse_objective_order(const std::string& str) {
+    std::vector<Objective> order;
+    for (size_t begin{}; begin <= str.size();) {
+        const auto end = std::min(str.find(',', begin), str.size());
+        const auto objective = parse_objective(str.substr(begin, end - begin));
+        for (const auto previous : order)
+            if (previous == objective)
+                throw std::runtime_error(fmt::format("objective '{}' appears twice", objective_names.at(unsigned(objective))));
+        order.push_back(objective);
+        begin = end + 1;
+    }
+    return order;
+}
+
 struct solve_config {
     unsigned range_attempts;
     unsigned range_increment;
+    // with BOUNDARY, "range_attempts" and "range_increment" do not apply
+    CandidateMode candidate_mode;
     bool minimize_wishes_prio;
     bool minimize_holes;
     unsigned lunch_time_from_hour;
@@ -21,9 +177,61 @@ struct solve_config {
     unsigned non_lunch_hole_prio;
     bool allow_skip;
     unsigned skip_prio;
+    ConflictEncoding conflict_encoding;
+    HoleEncoding hole_encoding;
+    double max_time_in_seconds; // 0 = no limit; the best solution found so far is returned
+    double relative_gap_limit;  // 0 = prove optimality
+    bool repair_hint;           // let the solver repair an infeasible hint instead of just starting from it
+    bool decompose;             // solve independent groups of students as separate models in parallel
+    unsigned num_workers;       // CP-SAT search workers in total; 0 = solver default
+    bool precheck;              // detect infeasibility with a flow relaxation before building the model
+    // keep interchangeable students (same candidates, wishes and lesson length) in a fixed order of their starts.
+    // alternatives then never differ by swapping such students only.
+    bool break_symmetry;
+    SolveMode solve_mode;
+    // empty: one weighted objective. otherwise the objectives are minimized in this order, each stage keeping the
+    // optimum of the previous ones. unlisted objectives follow in the default order, switched off ones are left out.
+    std::vector<Objective> objective_order;
+    // minutes per cell of the model, a multiple of MIN_ALIGNMENT which divides a day. lessons start on cell
+    // boundaries and block whole cells; conflicts and holes are tracked per cell.
+    unsigned time_granularity;
+    // 0 = off. otherwise the model is solved with cells of this many minutes first, and then with
+    // "time_granularity", keeping every student within one coarse cell of its coarse start.
+    unsigned coarse_granularity;
+    // with INTERVAL, "conflict_encoding" and "hole_encoding" do not apply
+    ModelEncoding model_encoding;
+    // further schedules to return besides the best one (0 = none), each differing from all before it in the
+    // lessons of at least "alternative_distance" students. the students are then solved as one model.
+    unsigned alternatives;
+    unsigned alternative_distance;
 };
 
-constexpr unsigned MIN_ALIGNMENT = 10;
+// minutes per chunk, the resolution of all times
+constexpr unsigned MIN_ALIGNMENT = 5;
 constexpr size_t slots_per_week = (7 * 24 * 60) / MIN_ALIGNMENT;
-constexpr bool enumerate_all_solutions = false;
+constexpr unsigned default_time_granularity = 10;
+
+inline unsigned validate_time_granularity(unsigned minutes) {
+    if (minutes == 0 || minutes % MIN_ALIGNMENT != 0 || (24 * 60) % minutes != 0)
+        throw std::runtime_error(fmt::format("invalid time granularity {} (needs to be a multiple of {} minutes which divides a day)", minutes, MIN_ALIGNMENT));
+    return minutes;
+}
+
+// 0 = off; otherwise a multiple of the fine granularity, so that the coarse starts are fine ones as well
+inline unsigned validate_coarse_granularity(unsigned minutes, unsigned time_granularity) {
+    if (minutes != 0 && (validate_time_granularity(minutes) % time_granularity != 0))
+        throw std::runtime_error(fmt::format("invalid coarse granularity {} (needs to be a multiple of the time granularity {})", minutes, time_granularity));
+    return minutes;
+}
+
+// alternatives which do not differ would be the same schedule
+inline unsigned validate_alternative_distance(unsigned students) {
+    if (students == 0)
+        throw std::runtime_error("the alternatives need to differ in at least one student");
+    return students;
+}
+
+inline unsigned chunks_per_cell(const struct solve_config& cfg) { return cfg.time_granularity / MIN_ALIGNMENT; }
+inline unsigned cells_per_day(const struct solve_config& cfg) { return 24 * 60 / cfg.time_granularity; }
+inline unsigned cells_per_week(const struct solve_config& cfg) { return 7 * cells_per_day(cfg); }
 constexpr bool print_stats = true;
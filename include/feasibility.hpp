@@ -0,0 +1,155 @@
+#pragma once
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <vector>
+#include "config.hpp"
+#include "week_mask.hpp"
+
+// Dinic's algorithm on an adjacency list with paired reverse edges
+class MaxFlow {
+    public:
+        explicit MaxFlow(size_t node_count) : graph(node_count), level(node_count), next(node_count) {}
+
+        void add_edge(size_t from, size_t to, int capacity) {
+            graph[from].push_back({to, graph[to].size(), capacity});
+            graph[to].push_back({from, graph[from].size() - 1, 0});
+        }
+
+        int run(size_t source, size_t sink) {
+            int flow{};
+            while (build_levels(source, sink)) {
+                std::fill(next.begin(), next.end(), 0);
+                while (const int pushed = augment(source, sink, std::numeric_limits<int>::max()))
+                    flow += pushed;
+            }
+            return flow;
+        }
+
+        // nodes reachable from "source" in the residual graph, i.e. the source side of a minimum cut
+        std::vector<bool> reachable(size_t source) const {
+            std::vector<bool> seen(graph.size());
+            std::queue<size_t> queue;
+            seen[source] = true;
+            queue.push(source);
+            while (!queue.empty()) {
+                const auto node = queue.front();
+                queue.pop();
+                for (const auto& e : graph[node])
+                    if (e.capacity > 0 && !seen[e.to]) {
+                        seen[e.to] = true;
+                        queue.push(e.to);
+                    }
+            }
+            return seen;
+        }
+
+    protected:
+        struct edge {
+            size_t to;
+            size_t reverse;
+            int capacity;
+        };
+
+        bool build_levels(size_t source, size_t sink) {
+            std::fill(level.begin(), level.end(), -1);
+            std::queue<size_t> queue;
+            level[source] = 0;
+            queue.push(source);
+            while (!queue.empty()) {
+                const auto node = queue.front();
+                queue.pop();
+                for (const auto& e : graph[node])
+                    if (e.capacity > 0 && level[e.to] < 0) {
+                        level[e.to] = level[node] + 1;
+                        queue.push(e.to);
+                    }
+            }
+            return level[sink] >= 0;
+        }
+
+        int augment(size_t node, size_t sink, int limit) {
+            if (node == sink)
+                return limit;
+            for (auto& i = next[node]; i < graph[node].size(); ++i) {
+                auto& e = graph[node][i];
+                if (e.capacity <= 0 || level[e.to] != level[node] + 1)
+                    continue;
+                if (const int pushed = augment(e.to, sink, std::min(limit, e.capacity))) {
+                    e.capacity -= pushed;
+                    graph[e.to][e.reverse].capacity += pushed;
+                    return pushed;
+                }
+            }
+            return 0;
+        }
+
+        std::vector<std::vector<edge>> graph;
+        std::vector<int> level;
+        std::vector<size_t> next;
+};
+
+// a student as seen by the pre-check: how many chunks the lesson needs and which chunks any candidate covers
+struct feasibility_demand {
+    unsigned chunks;
+    WeekMask coverage;
+};
+
+struct feasibility_report {
+    bool feasible{true};
+    unsigned min_skipped{};           // lower bound on the number of students which have to be skipped
+    std::vector<size_t> conflicting;  // students (by index) which cannot all get their chunks
+};
+
+// relaxation of the schedule which drops the contiguity of lessons: every student needs "chunks" distinct chunks of
+// its coverage, and every chunk can be given to one student. this is a flow from the students to the chunks; if
+// the maximum flow does not satisfy all demands, no schedule exists. the students on the source side of the minimum
+// cut are the ones competing for too few chunks.
+// skipping a set of students lowers the demand by their chunks and the flow by at most as much, so at least the
+// "deficit" has to be skipped, which gives the lower bound on the number of skipped students.
+inline feasibility_report check_feasibility(const std::vector<feasibility_demand>& demands) {
+    WeekMask all;
+    for (const auto& demand : demands)
+        all |= demand.coverage;
+
+    const size_t source{0};
+    std::vector<size_t> node_of_chunk(slots_per_week);
+    size_t node_count = 1 + demands.size();
+    all.for_each([&](unsigned chunk_of_week) { node_of_chunk[chunk_of_week] = node_count++; });
+    const size_t sink = node_count++;
+
+    MaxFlow flow(node_count);
+    int demand_sum{};
+    for (size_t index{}; index < demands.size(); ++index) {
+        const auto& demand = demands[index];
+        flow.add_edge(source, 1 + index, demand.chunks);
+        demand.coverage.for_each([&](unsigned chunk_of_week) { flow.add_edge(1 + index, node_of_chunk[chunk_of_week], 1); });
+        demand_sum += demand.chunks;
+    }
+    all.for_each([&](unsigned chunk_of_week) { flow.add_edge(node_of_chunk[chunk_of_week], sink, 1); });
+
+    feasibility_report report;
+    const int deficit = demand_sum - flow.run(source, sink);
+    if (deficit == 0)
+        return report;
+
+    report.feasible = false;
+    const auto reachable = flow.reachable(source);
+    for (size_t index{}; index < demands.size(); ++index)
+        if (reachable[1 + index])
+            report.conflicting.push_back(index);
+
+    std::vector<unsigned> chunks;
+    for (const auto& demand : demands)
+        chunks.push_back(demand.chunks);
+    std::sort(chunks.begin(), chunks.end(), std::greater<>());
+    int covered{};
+    for (const auto c : chunks) {
+        if (covered >= deficit)
+            break;
+        covered += c;
+        ++report.min_skipped;
+    }
+    return report;
+}
@@ -0,0 +1,206 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <vector>
+#include "config.hpp"
+#include "time.hpp"
+
+// the hole priorities are per 10 minutes
+constexpr unsigned hole_weight_minutes = 10;
+
+// weight of a hole in the cell starting at "t"
+inline int64_t hole_weight(Time t, const struct solve_config& cfg) {
+    const Time lunch_from(t.get_day(), cfg.lunch_time_from_hour, cfg.lunch_time_from_minute),
+               lunch_to(t.get_day(), cfg.lunch_time_to_hour, cfg.lunch_time_to_minute);
+
+    // if the hole falls into a lunch break, that's OK! :-)
+    const int64_t weight = t >= lunch_from && t < lunch_to ? -int64_t(cfg.lunch_hole_neg_prio) : int64_t(cfg.non_lunch_hole_prio);
+    return weight * int64_t(cfg.time_granularity) / int64_t(hole_weight_minutes);
+}
+
+// a student as seen by the heuristic: the cells a lesson blocks, the (cell aligned) candidate starts with their
+// wish priority, and the position in the input list (lower = placed first)
+struct heuristic_student {
+    struct candidate {
+        Time start;
+        int64_t prio;
+    };
+    unsigned cells;
+    unsigned order;
+    std::vector<candidate> candidates;
+};
+
+// greedy construction followed by local search. the objective is the one of the CP-SAT model: wish priorities,
+// skip penalties and hole weights of "solve_config".
+class Heuristic {
+    public:
+        static constexpr unsigned max_passes = 100;
+
+        Heuristic(const std::vector<heuristic_student>& students, const struct solve_config& cfg) :
+            students{students},
+            cfg{cfg},
+            assignment(students.size()),
+            chunks_per_cell{::chunks_per_cell(cfg)},
+            cells_per_day{::cells_per_day(cfg)},
+            owner(cells_per_week(cfg), free),
+            weight(cells_per_week(cfg)) {
+            // like the model, only cells which some candidate covers can be a hole
+            std::vector<bool> covered(weight.size());
+            for (const auto& student : students) {
+                for (const auto& candidate : student.candidates) {
+                    const unsigned first = candidate.start.get_chunk_of_week() / chunks_per_cell;
+                    std::fill(covered.begin() + std::min<size_t>(first, covered.size()),
+                              covered.begin() + std::min<size_t>(first + student.cells, covered.size()), true);
+                }
+            }
+            for (unsigned cell{}; cell < weight.size(); ++cell)
+                weight[cell] = covered[cell] ? hole_weight(Time(cell * chunks_per_cell), cfg) : 0;
+        }
+
+        // false if a student could not be placed and skipping is not allowed
+        bool run() {
+            std::vector<size_t> order(students.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return students[a].order < students[b].order; });
+
+            // every student gets the first of its candidates (best wish, earliest start) which is still free
+            for (const auto index : order) {
+                const auto& candidates = students[index].candidates;
+                for (size_t c{}; c < candidates.size(); ++c) {
+                    if (fits(index, c)) {
+                        place(index, c);
+                        break;
+                    }
+                }
+                if (!assignment[index] && !cfg.allow_skip)
+                    return false;
+            }
+
+            // relocate single students (or un-skip them) as long as that improves the objective
+            for (unsigned pass{}; pass < max_passes; ++pass) {
+                bool improved{false};
+                for (const auto index : order)
+                    improved |= improve(index);
+                if (!improved)
+                    break;
+            }
+            return true;
+        }
+
+        // chosen candidate per student, nothing if the student is skipped
+        const std::vector<std::optional<size_t>>& get_assignment() const { return assignment; }
+
+        int64_t get_objective() const {
+            int64_t objective{};
+            for (size_t index{}; index < students.size(); ++index)
+                objective += student_cost(index, assignment[index]);
+            for (unsigned day{}; day < 7; ++day)
+                objective += hole_cost(day);
+            return objective;
+        }
+
+    protected:
+        static constexpr size_t free = std::numeric_limits<size_t>::max();
+
+        unsigned first_cell(size_t index, size_t c) const { return students[index].candidates[c].start.get_chunk_of_week() / chunks_per_cell; }
+
+        bool fits(size_t index, size_t c) const {
+            const unsigned first = first_cell(index, c);
+            if (first + students[index].cells > owner.size())
+                return false;
+            for (unsigned cell = first; cell < first + students[index].cells; ++cell)
+                if (owner[cell] != free && owner[cell] != index)
+                    return false;
+            return true;
+        }
+
+        void occupy(size_t index, size_t c, size_t who) {
+            const unsigned first = first_cell(index, c);
+            std::fill_n(owner.begin() + first, students[index].cells, who);
+        }
+
+        void place(size_t index, size_t c) {
+            occupy(index, c, index);
+            assignment[index] = c;
+        }
+
+        void unplace(size_t index) {
+            if (assignment[index])
+                occupy(index, *assignment[index], free);
+            assignment[index].reset();
+        }
+
+        int64_t student_cost(size_t index, const std::optional<size_t>& c) const {
+            if (!c)
+                return cfg.allow_skip ? cfg.skip_prio : 0;
+            return cfg.minimize_wishes_prio ? students[index].candidates[*c].prio : 0;
+        }
+
+        // weights of the unused cells between the first and the last used cell of the day. "weight" is 0 for the
+        // cells no candidate covers, so this is the hole objective of the model.
+        int64_t hole_cost(unsigned day) const {
+            if (!cfg.minimize_holes)
+                return 0;
+            const unsigned begin = day * cells_per_day, end = begin + cells_per_day;
+            unsigned first = end, last = begin;
+            for (unsigned cell = begin; cell < end; ++cell) {
+                if (owner[cell] != free) {
+                    first = std::min(first, cell);
+                    last = cell;
+                }
+            }
+            int64_t cost{};
+            for (unsigned cell = first; cell < last; ++cell)
+                if (owner[cell] == free)
+                    cost += weight[cell];
+            return cost;
+        }
+
+        unsigned day_of(size_t index, size_t c) const { return first_cell(index, c) / cells_per_day; }
+
+        int64_t local_cost(size_t index, const std::optional<size_t>& c, unsigned day_a, unsigned day_b) const {
+            return student_cost(index, c) + hole_cost(day_a) + (day_b != day_a ? hole_cost(day_b) : 0);
+        }
+
+        // moves the student to the best improving candidate, if there is one
+        bool improve(size_t index) {
+            const auto current = assignment[index];
+            const unsigned current_day = current ? day_of(index, *current) : 0;
+
+            int64_t best_delta{};
+            std::optional<size_t> best;
+            for (size_t c{}; c < students[index].candidates.size(); ++c) {
+                if (c == current || !fits(index, c))
+                    continue;
+                const unsigned day = day_of(index, c);
+                const int64_t before = local_cost(index, current, current_day, day);
+                unplace(index);
+                place(index, c);
+                const int64_t after = local_cost(index, c, current_day, day);
+                unplace(index);
+                if (current)
+                    place(index, *current);
+                if (after - before < best_delta) {
+                    best_delta = after - before;
+                    best = c;
+                }
+            }
+
+            if (!best)
+                return false;
+            unplace(index);
+            place(index, *best);
+            return true;
+        }
+
+        const std::vector<heuristic_student>& students;
+        const struct solve_config& cfg;
+        std::vector<std::optional<size_t>> assignment;
+        const unsigned chunks_per_cell;
+        const unsigned cells_per_day;
+        std::vector<size_t> owner;
+        std::vector<int64_t> weight;
+};
@@ -0,0 +1,137 @@
+#pragma once
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <fmt/format.h>
+
+// just enough HTTP to talk to the job server. the requests are HTTP/1.0, so the response is never chunked and ends
+// with the connection. every request opens a new connection; there are only a few per job.
+class HttpClient {
+    public:
+        static constexpr unsigned timeout_seconds = 30;
+
+        // "http://host[:port][/prefix]"
+        explicit HttpClient(const std::string& url) {
+            constexpr std::string_view scheme = "http://";
+            if (!url.starts_with(scheme))
+                throw std::runtime_error(fmt::format("unsupported URL `{}' (only http:// is supported)", url));
+
+            const auto authority_begin = scheme.size();
+            const auto path_begin = std::min(url.find('/', authority_begin), url.size());
+            const auto authority = url.substr(authority_begin, path_begin - authority_begin);
+            prefix = url.substr(path_begin);
+            while (prefix.ends_with('/'))
+                prefix.pop_back();
+
+            const auto colon = authority.rfind(':');
+            if (colon != std::string::npos && authority.find(']', colon) == std::string::npos) {
+                host = authority.substr(0, colon);
+                port = authority.substr(colon + 1);
+            } else {
+                host = authority;
+                port = "80";
+            }
+            if (host.starts_with('[') && host.ends_with(']'))
+                host = host.substr(1, host.size() - 2);
+            if (host.empty())
+                throw std::runtime_error(fmt::format("no host in URL `{}'", url));
+        }
+
+        // both return the response body and throw if the server does not answer with 2xx
+        std::string get(const std::string& path) const { return request("GET", path, {}); }
+        std::string post(const std::string& path, const std::string& body) const { return request("POST", path, body); }
+
+    protected:
+        class socket_guard {
+            public:
+                explicit socket_guard(int fd) : fd{fd} {}
+                socket_guard(const socket_guard&) = delete;
+                socket_guard& operator=(const socket_guard&) = delete;
+                ~socket_guard() { close(fd); }
+                const int fd;
+        };
+
+        int connect_to_server() const {
+            addrinfo hints{};
+            hints.ai_family = AF_UNSPEC;
+            hints.ai_socktype = SOCK_STREAM;
+            addrinfo* addresses;
+            if (const int error = getaddrinfo(host.c_str(), port.c_str(), &hints, &addresses))
+                throw std::runtime_error(fmt::format("cannot resolve {}: {}", host, gai_strerror(error)));
+
+            int fd{-1};
+            for (auto address = addresses; address; address = address->ai_next) {
+                fd = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+                if (fd < 0)
+                    continue;
+                if (connect(fd, address->ai_addr, address->ai_addrlen) == 0)
+                    break;
+                close(fd);
+                fd = -1;
+            }
+            freeaddrinfo(addresses);
+            if (fd < 0)
+                throw std::runtime_error(fmt::format("cannot connect to {}:{}: {}", host, port, std::strerror(errno)));
+
+            const timeval timeout{.tv_sec = timeout_seconds, .tv_usec = 0};
+            setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+            setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+            return fd;
+        }
+
+        std::string request(const char* method, const std::string& path, const std::string& body) const {
+            const socket_guard connection(connect_to_server());
+
+            const auto message = fmt::format(
+                "{} {}{} HTTP/1.0\r\n"
+                "Host: {}\r\n"
+                "Accept: application/json\r\n"
+                "Content-Type: application/json\r\n"
+                "Content-Length: {}\r\n"
+                "\r\n"
+                "{}", method, prefix, path, host, body.size(), body);
+            for (size_t sent{}; sent < message.size();) {
+                const auto n = send(connection.fd, message.data() + sent, message.size() - sent, MSG_NOSIGNAL);
+                if (n < 0) {
+                    if (errno == EINTR)
+                        continue;
+                    throw std::runtime_error(fmt::format("{} {}: sending failed: {}", method, path, std::strerror(errno)));
+                }
+                sent += n;
+            }
+
+            std::string response;
+            char buffer[4096];
+            for (;;) {
+                const auto n = recv(connection.fd, buffer, sizeof(buffer), 0);
+                if (n < 0) {
+                    if (errno == EINTR)
+                        continue;
+                    throw std::runtime_error(fmt::format("{} {}: receiving failed: {}", method, path, std::strerror(errno)));
+                }
+                if (n == 0)
+                    break;
+                response.append(buffer, n);
+            }
+
+            // "HTTP/1.x NNN reason"
+            const auto header_end = response.find("\r\n\r\n");
+            const auto status_begin = response.find(' ');
+            if (header_end == std::string::npos || status_begin == std::string::npos || !response.starts_with("HTTP/"))
+                throw std::runtime_error(fmt::format("{} {}: malformed response", method, path));
+            const unsigned status = std::atoi(response.c_str() + status_begin + 1);
+            if (status < 200 || status >= 300)
+                throw std::runtime_error(fmt::format("{} {}: HTTP status {}", method, path, status));
+            return response.substr(header_end + 4);
+        }
+
+        std::string host;
+        std::string port;
+        std::string prefix;
+};
@@ -1,26 +1,68 @@
 #pragma once
 
 #include "config.hpp"
+#include "feasibility.hpp"
+#include "heuristic.hpp"
+#include "result_cache.hpp"
+#include "slot_index.hpp"
+#include "statistics.hpp"
 #include "time.hpp"
+#include "thread_pool.hpp"
+#include "week_mask.hpp"
 #include "fmt/format.h"
 #include "ortools/sat/cp_model.h"
 #include "ortools/sat/cp_model_solver.h"
+#include "ortools/util/time_limit.h"
 #ifdef PLAN_PY
 #include <Python.h>
 #endif
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <memory_resource>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <unordered_map>
 
 constexpr unsigned default_range_attempts = std::numeric_limits<unsigned>::max();
 constexpr unsigned default_range_increment = 1;
 
+using operations_research::Domain;
 using operations_research::sat::BoolVar;
 using operations_research::sat::CpModelBuilder;
+using operations_research::sat::CpModelProto;
 using operations_research::sat::CpSolverResponse;
 using operations_research::sat::CpSolverStatus;
+using operations_research::sat::CpSolverStatus_Name;
+using operations_research::sat::IntervalVar;
+using operations_research::sat::IntVar;
 using operations_research::sat::Model;
 using operations_research::sat::SatParameters;
 using operations_research::sat::NewFeasibleSolutionObserver;
 using operations_research::sat::LinearExpr;
+using operations_research::TimeLimit;
+
+// names a model variable; the name is not even formatted unless the build keeps names (see "build_mode")
+template <typename Var, typename... Args>
+Var named(Var var, fmt::format_string<Args...> format, Args&&... args) {
+    if constexpr (build_mode::named_variables)
+        return var.WithName(fmt::format(format, std::forward<Args>(args)...));
+    else
+        return var;
+}
+
+// a candidate start of a lesson, as a term of the wish objective
+struct wish {
+    BoolVar var;
+    unsigned prio;
+};
 
 class Student {
     public:
@@ -42,81 +84,330 @@ class Student {
         const std::string& get_name() const { return name; }
         unsigned get_lesson_duration() const { return lesson_duration * MIN_ALIGNMENT; }
         unsigned get_lesson_chunks() const { return lesson_duration; }
+        // cells blocked by a lesson, which starts on a cell boundary
+        unsigned get_lesson_cells(const struct solve_config& cfg) const {
+            return (lesson_duration + chunks_per_cell(cfg) - 1) / chunks_per_cell(cfg);
+        }
+        unsigned get_student_prio() const { return student_prio; }
         size_t get_availability_count() const { return availabilities.size(); }
+        const std::vector<std::pair<Time, Time>>& get_availability_ranges() const { return availability_ranges; }
 
         void add_availability(Time start, Time end) {
             availability_ranges.emplace_back(start, end);
         }
 
-        void calculate_availabilities(CpModelBuilder& cp_model,
-                                      std::vector<std::list<std::tuple<BoolVar, unsigned>>>& wishes,
-                                      const struct solve_config& cfg) {
+        struct candidate {
+            Time start;
+            unsigned availability_index;
+        };
+
+        // every "range_increment"-th cell boundary of each availability range, at most "range_attempts" per range.
+        // with CandidateMode::BOUNDARY, every cell boundary which is one of the anchors instead. a range always
+        // yields its first cell boundary, even if the lesson does not fit into it, unless that boundary lies behind
+        // the end of the range. with a focus, only the starts within it are kept (if any).
+        std::vector<candidate> get_candidates(const struct solve_config& cfg) const {
+            const unsigned cell = chunks_per_cell(cfg);
+            const bool boundary = cfg.candidate_mode == CandidateMode::BOUNDARY;
+            std::vector<candidate> candidates;
+            unsigned availability_index{};
+            for (const auto& [start, end] : availability_ranges) {
+                const Time check_end = end - lesson_duration;
+                const Time first = Time((start.get_chunk_of_week() + cell - 1) / cell * cell);
+                Time t = first;
+                unsigned attempt{};
+                if (t <= end) {
+                    do {
+                        if (!boundary || t == first || !anchors || anchors->test(t.get_chunk_of_week()))
+                            candidates.emplace_back(t, availability_index);
+                        t += (boundary ? 1 : cfg.range_increment) * cell;
+                        ++attempt;
+                    } while (t <= check_end && (boundary || attempt < cfg.range_attempts));
+                }
+                ++availability_index;
+            }
+
+            if (focus) {
+                std::vector<candidate> focused;
+                for (const auto& c : candidates)
+                    if (focus->first <= c.start && c.start <= focus->second)
+                        focused.push_back(c);
+                if (!focused.empty())
+                    return focused;
+            }
+            return candidates;
+        }
+
+        // restricts the candidates to the starts in [from, to]; nothing = all candidates
+        void set_focus(std::optional<std::pair<Time, Time>> focus) {
+            this->focus = focus;
+        }
+
+        // the cell boundaries CandidateMode::BOUNDARY starts at; nothing = all of them
+        void set_anchors(std::shared_ptr<const WeekMask> anchors) {
+            this->anchors = std::move(anchors);
+        }
+
+        // chunks of the cells covered by any of the candidate lessons
+        WeekMask get_candidate_mask(const struct solve_config& cfg) const {
+            const unsigned blocked = get_lesson_cells(cfg) * chunks_per_cell(cfg);
+            WeekMask mask;
+            for (const auto& [t, availability_index] : get_candidates(cfg))
+                mask.set_range(t, t + blocked);
+            return mask;
+        }
+
+        unsigned get_wish_prio(unsigned availability_index) const {
+            // the factor "10" doesn't really do much here, since *everyone* gets it.
+            // it's just there so that the division by "student_prio" has something to work with and stay an integer
+            return 10 * availability_index / student_prio;
+        }
+
+        // students with the same key can swap their lessons without changing the objective: the same lesson length
+        // and the same candidate starts with the same wish priorities. "student_prio" only counts through the
+        // rounded priorities, which often agree for the later students or a single availability range.
+        std::vector<int64_t> get_symmetry_key(const struct solve_config& cfg) const {
+            std::vector<int64_t> key{lesson_duration};
+            for (const auto& [t, availability_index] : get_candidates(cfg)) {
+                key.push_back(t.get_chunk_of_week());
+                key.push_back(get_wish_prio(availability_index));
+            }
+            return key;
+        }
+
+        // a candidate start with its literal
+        struct availability {
+            Time start;
+            BoolVar var;
+            unsigned prio;
+        };
+
+        void calculate_availabilities(CpModelBuilder& cp_model, const struct solve_config& cfg) {
             availabilities.clear();
+            windows.clear();
 
+            const auto candidates = get_candidates(cfg);
+            availabilities.reserve(candidates.size());
             std::vector<BoolVar> all_vars;
+            all_vars.reserve(candidates.size() + 1);
 
             // XXX
             if (cfg.allow_skip) {
-                const auto s = fmt::format("skip {}", name);
-                skip = cp_model.NewBoolVar().WithName(s);
+                skip = named(cp_model.NewBoolVar(), "skip {}", name);
                 all_vars.push_back(skip);
             }
 
-            unsigned availability_index{};
-            for (const auto& [start, end] : availability_ranges) {
-                const Time check_end = end - lesson_duration;
-                Time t = start;
-                unsigned attempt{};
-                do {
-                    const auto s = fmt::format("{} at {} (+{})", name, t, get_lesson_duration());
-                    auto var = cp_model.NewBoolVar().WithName(s);
-                    availabilities.emplace_back(t, var);
-                    all_vars.push_back(var);
-                    // the factor "10" doesn't really do much here, since *everyone* gets it.
-                    // it's just there so that the division by "student_prio" has something to work with and stay an integer
-                    const unsigned prio = 10 * availability_index / student_prio;
-                    AT(wishes, t.get_chunk_of_week()).emplace_back(var, prio);
-                    t += cfg.range_increment;
-                    ++attempt;
-                } while (t <= check_end && attempt < cfg.range_attempts);
-                ++availability_index;
+            for (const auto& [t, availability_index] : candidates) {
+                auto var = named(cp_model.NewBoolVar(), "{} at {} (+{})", name, t, get_lesson_duration());
+                availabilities.emplace_back(t, var, get_wish_prio(availability_index));
+                all_vars.push_back(var);
             }
 
             // there should be only one lesson per week for each student
             cp_model.AddExactlyOne(all_vars);
         }
 
-        void register_conflicts(CpModelBuilder& cp_model,
-                                std::vector<std::list<std::tuple<BoolVar, unsigned>>>& wishes) {
-            for (const auto& [t, var] : availabilities) {
-                const auto end = t + lesson_duration;
-                for (auto t2 = t; t2 < end; t2 += 1)
-                    for (const auto& [w, prio] : AT(wishes, t2.get_chunk_of_week()))
+        // the candidates of one availability range as an optional interval. "start" counts the cells of the day,
+        // "starts" are its values.
+        struct window {
+            unsigned day;
+            unsigned availability_index;
+            unsigned chunks_per_cell;
+            std::vector<int64_t> starts;
+            IntVar start;
+            BoolVar present;
+            IntervalVar interval;
+
+            unsigned get_first_cell() const { return day * 24 * 60 / MIN_ALIGNMENT / chunks_per_cell; }
+            Time get_time(int64_t start_value) const { return Time((get_first_cell() + start_value) * chunks_per_cell); }
+        };
+
+        // the interval encoding of "calculate_availabilities": the size of the model grows with the number of
+        // availability ranges instead of the number of candidates
+        void calculate_windows(CpModelBuilder& cp_model, const struct solve_config& cfg) {
+            availabilities.clear();
+            windows.clear();
+
+            std::vector<BoolVar> all_vars;
+
+            if (cfg.allow_skip) {
+                skip = named(cp_model.NewBoolVar(), "skip {}", name);
+                all_vars.push_back(skip);
+            }
+
+            // the candidates come ordered by their range
+            const unsigned cell = chunks_per_cell(cfg);
+            for (const auto& [t, availability_index] : get_candidates(cfg)) {
+                if (windows.empty() || windows.back().availability_index != availability_index) {
+                    auto& window = windows.emplace_back();
+                    window.day = unsigned(t.get_day());
+                    window.availability_index = availability_index;
+                    window.chunks_per_cell = cell;
+                }
+                windows.back().starts.push_back(t.get_chunk_of_week() / cell - windows.back().get_first_cell());
+            }
+
+            const unsigned cells = get_lesson_cells(cfg);
+            for (auto& window : windows) {
+                const unsigned range = window.availability_index + 1;
+                window.present = named(cp_model.NewBoolVar(), "{} in range {} (+{})", name, range, get_lesson_duration());
+                window.start = named(cp_model.NewIntVar(Domain::FromValues(window.starts)), "start of {} in range {} (+{})", name, range, get_lesson_duration());
+                window.interval = cp_model.NewOptionalFixedSizeIntervalVar(window.start + int64_t(window.get_first_cell()), cells, window.present);
+                all_vars.push_back(window.present);
+            }
+
+            cp_model.AddExactlyOne(all_vars);
+        }
+
+        const std::vector<availability>& get_availabilities() const { return availabilities; }
+        const std::vector<window>& get_windows() const { return windows; }
+
+        // indices of the model variables which decide this student's lesson
+        std::vector<int> get_decision_vars(const struct solve_config& cfg) const {
+            std::vector<int> vars;
+            if (cfg.allow_skip)
+                vars.push_back(skip.index());
+            for (const auto& [t, var, prio] : availabilities)
+                vars.push_back(var.index());
+            for (const auto& window : windows) {
+                vars.push_back(window.present.index());
+                vars.push_back(window.start.index());
+            }
+            return vars;
+        }
+
+        // hints the candidate at "start" (and no skip), if it is still one of this student's candidates
+        bool add_hint(CpModelBuilder& cp_model, Time start, const struct solve_config& cfg) {
+            if (!windows.empty())
+                return add_window_hint(cp_model, start, cfg);
+
+            const auto it = std::find_if(availabilities.begin(), availabilities.end(),
+                                         [&](const auto& availability) { return availability.start == start; });
+            if (it == availabilities.end())
+                return false;
+
+            for (const auto& [t, var, prio] : availabilities)
+                cp_model.AddHint(var, t == start);
+            if (cfg.allow_skip)
+                cp_model.AddHint(skip, false);
+            return true;
+        }
+
+        // all candidates start on cell boundaries, so only the first chunk of each blocked cell has wishes
+        bool add_window_hint(CpModelBuilder& cp_model, Time start, const struct solve_config& cfg) {
+            const auto hinted = std::find_if(windows.begin(), windows.end(), [&](const auto& window) {
+                return std::find(window.starts.begin(), window.starts.end(),
+                                 int64_t(start.get_chunk_of_week() / chunks_per_cell(cfg)) - window.get_first_cell()) != window.starts.end();
+            });
+            if (hinted == windows.end())
+                return false;
+
+            for (const auto& window : windows) {
+                cp_model.AddHint(window.present, &window == &*hinted);
+                cp_model.AddHint(window.start, &window == &*hinted ? start.get_chunk_of_week() / chunks_per_cell(cfg) - window.get_first_cell() : window.starts.front());
+            }
+            if (cfg.allow_skip)
+                cp_model.AddHint(skip, false);
+            return true;
+        }
+
+        // "wishes" has one row per chunk of the week
+        void register_conflicts(CpModelBuilder& cp_model, const SlotIndex<wish>& wishes, const struct solve_config& cfg) const {
+            const unsigned cell = chunks_per_cell(cfg);
+            for (const auto& [t, var, prio] : availabilities) {
+                const auto end = t + get_lesson_cells(cfg) * cell;
+                for (auto t2 = t; t2 < end; t2 += cell)
+                    for (const auto& [w, other_prio] : AT(wishes, t2.get_chunk_of_week()))
                         if (w != var)
                             cp_model.AddImplication(var, w.Not());
             }
         }
 
-        void register_impact(std::vector<std::vector<BoolVar>>& impact) {
-            for (const auto& [t, var] : availabilities) {
-                const auto end = t + lesson_duration;
-                for (auto t2 = t; t2 < end; t2 += 1)
-                    AT(impact, t2.get_chunk_of_week()).push_back(var);
+        // calls "emit(cell, var)" for every cell of the week a candidate blocks, see "SlotIndex"
+        template <typename Emit>
+        void register_impact(Emit&& emit, const struct solve_config& cfg) const {
+            const unsigned cells = get_lesson_cells(cfg);
+            for (const auto& [t, var, prio] : availabilities) {
+                const unsigned first = t.get_chunk_of_week() / chunks_per_cell(cfg);
+                for (unsigned cell = first; cell < first + cells; ++cell)
+                    emit(cell, var);
             }
         }
 
+        // the cell the lesson starts in plus one, 0 if the student is skipped. with windows, this takes a new variable.
+        LinearExpr add_start_order(CpModelBuilder& cp_model, const struct solve_config& cfg) const {
+            LinearExpr order;
+            for (const auto& [t, var, prio] : availabilities)
+                order += LinearExpr::Term(var, t.get_chunk_of_week() / chunks_per_cell(cfg) + 1);
+            if (windows.empty())
+                return order;
+
+            const auto order_var = named(cp_model.NewIntVar(Domain(0, cells_per_week(cfg))), "start order of {}", name);
+            for (const auto& window : windows)
+                cp_model.AddEquality(order_var, window.start + int64_t(window.get_first_cell() + 1)).OnlyEnforceIf(window.present);
+            if (cfg.allow_skip)
+                cp_model.AddEquality(order_var, 0).OnlyEnforceIf(skip);
+            return order_var;
+        }
+
         // XXX
-        bool is_skipped(const CpSolverResponse& response) {
+        bool is_skipped(const CpSolverResponse& response) const {
             return SolutionIntegerValue(response, skip) == 1;
         }
 
-        Time get_solution_time(const CpSolverResponse& response) {
-            for (const auto& [t, var] : availabilities)
+        Time get_solution_time(const CpSolverResponse& response) const {
+            for (const auto& [t, var, prio] : availabilities)
                 if (SolutionIntegerValue(response, var) == 1)
                     return t;
+            for (const auto& window : windows)
+                if (SolutionIntegerValue(response, window.present) == 1)
+                    return window.get_time(SolutionIntegerValue(response, window.start));
+            throw std::runtime_error(fmt::format("no solution was found for {}", name));
+        }
+
+        // a literal which is true if and only if the lesson is placed (or skipped) as in "response": the chosen
+        // candidate literal itself, or for a window a new literal for "present at that start"
+        BoolVar add_same_placement(CpModelBuilder& cp_model, const CpSolverResponse& response, const struct solve_config& cfg) const {
+            if (cfg.allow_skip && is_skipped(response))
+                return skip;
+            for (const auto& [t, var, prio] : availabilities)
+                if (SolutionIntegerValue(response, var) == 1)
+                    return var;
+            for (const auto& window : windows) {
+                if (SolutionIntegerValue(response, window.present) != 1)
+                    continue;
+                const int64_t start = SolutionIntegerValue(response, window.start);
+                const auto same = named(cp_model.NewBoolVar(), "{} in range {} at {}", name, window.availability_index + 1, start);
+                cp_model.AddImplication(same, window.present);
+                cp_model.AddEquality(window.start, start).OnlyEnforceIf(same);
+                cp_model.AddNotEqual(window.start, start).OnlyEnforceIf({window.present, same.Not()});
+                return same;
+            }
             throw std::runtime_error(fmt::format("no solution was found for {}", name));
         }
 
+        // chunks a lesson of this student can touch, whole cells from the first to the last cell boundary a lesson
+        // fits behind. a window shorter than the lesson still gets its first candidate.
+        std::vector<std::pair<Time, Time>> get_coverage(const struct solve_config& cfg) const {
+            const unsigned cell = chunks_per_cell(cfg);
+            const unsigned blocked = get_lesson_cells(cfg) * cell;
+            std::vector<std::pair<Time, Time>> coverage;
+            for (const auto& [start, end] : availability_ranges) {
+                const unsigned first = (start.get_chunk_of_week() + cell - 1) / cell * cell;
+                if (first > end.get_chunk_of_week())
+                    continue;
+                const unsigned last = std::max(first, end.get_chunk_of_week() - std::min(end.get_chunk_of_week(), lesson_duration)) / cell * cell;
+                coverage.emplace_back(Time(first), Time(std::max(first, last) + blocked));
+            }
+            return coverage;
+        }
+
+        WeekMask get_coverage_mask(const struct solve_config& cfg) const {
+            WeekMask mask;
+            for (const auto& [start, end] : get_coverage(cfg))
+                mask.set_range(start, end);
+            return mask;
+        }
+
         unsigned get_priority(Time t) const {
             unsigned priority{};
             for (const auto& [start, end] : availability_ranges) {
@@ -135,25 +426,26 @@ class Student {
     BoolVar get_skip_var() { return skip; }
 
     protected:
-        const unsigned id;
-        const std::string name;
-        const unsigned lesson_duration;
-        const unsigned student_prio;
-        std::list<std::pair<Time, Time>> availability_ranges; // pair = (start_time, end_time)
-        std::list<std::pair<Time, BoolVar>> availabilities;
+        unsigned id;
+        std::string name;
+        unsigned lesson_duration;
+        unsigned student_prio;
+        std::vector<std::pair<Time, Time>> availability_ranges; // pair = (start_time, end_time)
+        std::vector<availability> availabilities;
+        std::vector<window> windows;
+        std::optional<std::pair<Time, Time>> focus;
+        std::shared_ptr<const WeekMask> anchors;
 
         // XXX
         BoolVar skip;
 };
 
-#ifdef DEBUG
 static const char* yon(bool b) { return b ? "\e[0;32m" "y" "\e[0m" : "\e[0;31m" "n" "\e[0m"; }
 static const char* ymn(bool b, bool m) { return m ? "\e[0;34m" "/" "\e[0m" : yon(b); }
-#endif
 
 static void AddOrEquality(CpModelBuilder& cp_model,
     const BoolVar& target,
-    const std::vector<BoolVar>& vars) {
+    absl::Span<const BoolVar> vars) {
     cp_model.AddBoolOr(vars).OnlyEnforceIf(target);
     std::vector<BoolVar> vars_not;
     for (auto& var : vars)
@@ -163,7 +455,7 @@ static void AddOrEquality(CpModelBuilder& cp_model,
 
 static void AddAndEquality(CpModelBuilder& cp_model,
     const BoolVar& target,
-    const std::vector<BoolVar>& vars) {
+    absl::Span<const BoolVar> vars) {
     cp_model.AddBoolAnd(vars).OnlyEnforceIf(target);
     std::vector<BoolVar> vars_not;
     for (auto& var : vars)
@@ -171,9 +463,137 @@ static void AddAndEquality(CpModelBuilder& cp_model,
     cp_model.AddBoolOr(vars_not).OnlyEnforceIf(target.Not());
 }
 
+// the weighted terms of one part of the objective, with the trivial lower bound of their sum
+struct objective_terms {
+    std::vector<IntVar> vars;
+    std::vector<int64_t> prios;
+    int64_t lower_bound{};
+
+    void add(BoolVar var, int64_t prio) {
+        vars.emplace_back(var);
+        prios.push_back(prio);
+        lower_bound += std::min<int64_t>(prio, 0);
+    }
+
+    // "var" takes values in [min, max]
+    void add(IntVar var, int64_t prio, int64_t min, int64_t max) {
+        vars.push_back(var);
+        prios.push_back(prio);
+        lower_bound += std::min(prio * min, prio * max);
+    }
+
+    LinearExpr sum() const { return LinearExpr::WeightedSum(vars, prios); }
+};
+
+// a "Plan::schedule" running on a thread of its own
+class ScheduleHandle {
+    public:
+        ScheduleHandle(std::future<bool>&& result, std::shared_ptr<std::atomic<bool>> stop) :
+            stop{std::move(stop)}, result{std::move(result)} {}
+
+        bool ready() const { return result.wait_for(std::chrono::seconds(0)) == std::future_status::ready; }
+        void wait() const { result.wait(); }
+        // true once the schedule is done
+        template <typename Rep, typename Period>
+        bool wait_for(const std::chrono::duration<Rep, Period>& timeout) const {
+            return result.wait_for(timeout) == std::future_status::ready;
+        }
+
+        // stops the solver, which then returns the best schedule found so far
+        void cancel() { *stop = true; }
+
+        // the return value of "schedule" (or its exception); only once
+        bool get() { return result.get(); }
+
+    protected:
+        // destroyed after "result", whose destructor waits for the solver which still reads the flag
+        std::shared_ptr<std::atomic<bool>> stop;
+        std::future<bool> result;
+};
+
 class Plan {
     public:
-        Plan(std::vector<Student>&& students) : students{students} {}
+        Plan(std::vector<Student>&& students) : students{std::move(students)} {}
+
+        // start time of a student in a previous schedule, used to warm-start the solver
+        struct schedule_hint {
+            unsigned id;
+            Time start;
+        };
+
+        void set_hint(std::vector<schedule_hint>&& hint) {
+            this->hint = std::move(hint);
+        }
+        const std::vector<schedule_hint>& get_hint() const { return hint; }
+
+        const std::vector<Student>& get_students() const { return students; }
+
+        // once "*stop" becomes true, the solver stops and the best schedule found so far is returned.
+        // may be set from any thread while "schedule" runs.
+        void set_stop_flag(std::atomic<bool>* stop) {
+            this->stop = stop;
+            owned_stop.reset();
+        }
+
+        // optimal schedules are taken from and put into "cache"; nothing = no caching
+        void set_cache(ResultCache* cache) {
+            this->cache = cache;
+        }
+
+        struct schedule_result;
+
+        // a schedule better than all reported before it: the weighted objective, the bound of the solve which
+        // found it (of the current stage in a lexicographic solve, the lowest double for the heuristic) and the
+        // seconds since "schedule" began
+        struct incumbent {
+            double objective_value;
+            double best_objective_bound;
+            double time;
+            std::vector<schedule_result> result;
+            std::vector<const Student *> skipped;
+        };
+
+        // called on the solver's threads, one call at a time, while "schedule" runs
+        using progress_callback = std::function<void(const incumbent&)>;
+        void set_progress_callback(progress_callback progress) {
+            this->progress = std::move(progress);
+        }
+
+        // hash of everything the optimum depends on: the students without their names, in input order, and the
+        // objective related settings. the search settings (encodings, decomposition, workers, mode, time limit)
+        // and the hint only change which of the optimal schedules is found, if any.
+        uint64_t get_input_hash(const struct solve_config& cfg) const {
+            CanonicalHash hash;
+            hash.add(uint64_t(students.size()));
+            for (const auto& student : students) {
+                hash.add(uint64_t(student.get_id()))
+                    .add(uint64_t(student.get_lesson_chunks()))
+                    .add(uint64_t(student.get_student_prio()))
+                    .add(uint64_t(student.get_availability_ranges().size()));
+                for (const auto& [start, end] : student.get_availability_ranges())
+                    hash.add(uint64_t(start.get_chunk_of_week())).add(uint64_t(end.get_chunk_of_week()));
+            }
+            hash.add(uint64_t(cfg.range_attempts))
+                .add(uint64_t(cfg.range_increment))
+                .add(uint64_t(cfg.candidate_mode))
+                .add(uint64_t(cfg.minimize_wishes_prio))
+                .add(uint64_t(cfg.minimize_holes))
+                .add(uint64_t(cfg.lunch_time_from_hour))
+                .add(uint64_t(cfg.lunch_time_from_minute))
+                .add(uint64_t(cfg.lunch_time_to_hour))
+                .add(uint64_t(cfg.lunch_time_to_minute))
+                .add(uint64_t(cfg.lunch_hole_neg_prio))
+                .add(uint64_t(cfg.non_lunch_hole_prio))
+                .add(uint64_t(cfg.allow_skip))
+                .add(uint64_t(cfg.skip_prio))
+                .add(cfg.relative_gap_limit)
+                .add(uint64_t(cfg.time_granularity))
+                .add(uint64_t(cfg.coarse_granularity))
+                .add(uint64_t(cfg.objective_order.size()));
+            for (const auto part : cfg.objective_order)
+                hash.add(uint64_t(part));
+            return hash.get();
+        }
 
         struct schedule_result {
             Time start;
@@ -181,207 +601,1330 @@ class Plan {
             const Student *student;
         };
 
+        // runs "schedule" on a thread of its own. the handle's stop flag replaces the one set before and is shared
+        // with the plan, so it stays valid for later calls of "schedule" after the handle is gone. the plan has to
+        // stay alive and must not be used until the handle is ready.
+        ScheduleHandle schedule_async(const struct solve_config& cfg) {
+            auto flag = std::make_shared<std::atomic<bool>>(false);
+            owned_stop = flag;
+            stop = flag.get();
+            return ScheduleHandle(std::async(std::launch::async, [this, cfg] { return schedule(cfg); }), std::move(flag));
+        }
+
         struct first_last_info {
             unsigned first;
             unsigned last;
             bool found;
         };
+        // per cell of the week
         std::array<first_last_info, 7> first_last_info_per_day{};
-        std::array<BoolVar, slots_per_week> used{};
-        std::array<BoolVar, slots_per_week> usage_before{};
-        std::array<BoolVar, slots_per_week> usage_after{};
-        std::array<BoolVar, slots_per_week> hole{};
+        std::vector<BoolVar> used;
+        std::vector<BoolVar> usage_before;
+        std::vector<BoolVar> usage_after;
+        std::vector<BoolVar> hole;
 
         int64_t get_hole_weight(Time t, const struct solve_config& cfg) {
-            const Time lunch_from(t.get_day(), cfg.lunch_time_from_hour, cfg.lunch_time_from_minute),
-                       lunch_to(t.get_day(), cfg.lunch_time_to_hour, cfg.lunch_time_to_minute);
+            return hole_weight(t, cfg);
+        }
+
+        // a cell whose candidates are a subset of a neighbouring cell's candidates is already covered by
+        // that cell's at-most-one and gets skipped. on ties, the earlier cell keeps the constraint.
+        // relies on the vars in each "impact" entry being sorted by index, which "register_impact" guarantees
+        // since all availability variables are created before and in student order.
+        void constraint_conflicts_at_most_one(CpModelBuilder& cp_model,
+                                              const SlotIndex<BoolVar>& impact) {
+            const auto by_index = [](const BoolVar& a, const BoolVar& b) { return a.index() < b.index(); };
+            const auto dominated_by = [&](unsigned cell, unsigned neighbour) {
+                const auto& vars = AT(impact, cell);
+                const auto& other = AT(impact, neighbour);
+                if (other.size() < vars.size() || (other.size() == vars.size() && neighbour > cell))
+                    return false;
+                return std::includes(other.begin(), other.end(), vars.begin(), vars.end(), by_index);
+            };
+
+            for (unsigned cell{}; cell < impact.size(); ++cell) {
+                const auto& vars = AT(impact, cell);
+                if (vars.size() < 2)
+                    continue;
+                if (cell > 0 && dominated_by(cell, cell - 1))
+                    continue;
+                if (cell + 1 < impact.size() && dominated_by(cell, cell + 1))
+                    continue;
+                cp_model.AddAtMostOne(vars);
+            }
+        }
 
-            // if the hole falls into a lunch break, that's OK! :-)
-            if (t >= lunch_from && t < lunch_to)
-                return -int64_t(cfg.lunch_hole_neg_prio);
-            else
-                return cfg.non_lunch_hole_prio;
+        // links each usage variable of the cells in [from, to] (walking in "direction") to the one of the
+        // previous cell which has a "used" variable. the first of these cells has no usage on its side.
+        void constraint_usage_chain(CpModelBuilder& cp_model,
+                                    std::vector<BoolVar>& usage,
+                                    unsigned from, unsigned to, int direction) {
+            const auto& FalseVar = cp_model.FalseVar();
+            std::optional<unsigned> previous;
+            for (int cell = from; cell != int(to) + direction; cell += direction) {
+                if (AT(used, cell) == FalseVar)
+                    continue;
+                if (previous)
+                    AddOrEquality(cp_model, AT(usage, cell), {AT(usage, *previous), AT(used, *previous)});
+                else
+                    cp_model.FixVariable(AT(usage, cell), false);
+                previous = cell;
+            }
         }
 
         void constraint_minimize_holes(CpModelBuilder& cp_model,
-                            std::vector<BoolVar>& objective_var,
-                            std::vector<int64_t>& objective_prio,
+                            const SlotIndex<BoolVar>& impact,
+                            objective_terms& holes,
                             const struct solve_config& cfg) {
 
-            std::vector<std::vector<BoolVar>> impact(slots_per_week);
-            for (auto& student : students)
-                student.register_impact(impact);
-
             const auto& FalseVar = cp_model.FalseVar();
 
-            std::fill(used.begin(), used.end(), FalseVar);
-            std::fill(usage_before.begin(), usage_before.end(), FalseVar);
-            std::fill(usage_after.begin(), usage_after.end(), FalseVar);
-            std::fill(hole.begin(), hole.end(), FalseVar);
+            used.assign(impact.size(), FalseVar);
+            usage_before.assign(impact.size(), FalseVar);
+            usage_after.assign(impact.size(), FalseVar);
+            hole.assign(impact.size(), FalseVar);
+            first_last_info_per_day = {};
 
-            constexpr unsigned chunks_per_day = 24 * 60 / MIN_ALIGNMENT;
+            const unsigned cells = cells_per_day(cfg);
             for (unsigned day{}; day < 7; ++day) {
                 auto& [first, last, found] = AT(first_last_info_per_day, day);
-                for (unsigned chunk_of_day{}; chunk_of_day < chunks_per_day; ++chunk_of_day) {
-                    const unsigned chunk_of_week = day * chunks_per_day + chunk_of_day;
+                for (unsigned cell_of_day{}; cell_of_day < cells; ++cell_of_day) {
+                    const unsigned cell = day * cells + cell_of_day;
 
-                    const auto& impact_for_slot = AT(impact, chunk_of_week);
+                    const auto& impact_for_slot = AT(impact, cell);
                     if (impact_for_slot.empty())
                         continue;
 
                     if (!found)
-                        first = chunk_of_week;
-                    last = chunk_of_week;
+                        first = cell;
+                    last = cell;
                     found = true;
 
-                    const Time t(chunk_of_week);
-                    AT(used, chunk_of_week) = cp_model.NewBoolVar().WithName(fmt::format("used {}", t));
-                    AT(usage_before, chunk_of_week) = cp_model.NewBoolVar().WithName(fmt::format("usage_before {}", t));
-                    AT(usage_after, chunk_of_week) = cp_model.NewBoolVar().WithName(fmt::format("usage_after {}", t));
-                    AT(hole, chunk_of_week) = cp_model.NewBoolVar().WithName(fmt::format("hole {}", t));
+                    const Time t(cell * chunks_per_cell(cfg));
+                    AT(used, cell) = named(cp_model.NewBoolVar(), "used {}", t);
+                    AT(usage_before, cell) = named(cp_model.NewBoolVar(), "usage_before {}", t);
+                    AT(usage_after, cell) = named(cp_model.NewBoolVar(), "usage_after {}", t);
+                    AT(hole, cell) = named(cp_model.NewBoolVar(), "hole {}", t);
 
-                    objective_var.push_back(AT(hole, chunk_of_week));
-                    objective_prio.push_back(get_hole_weight(t, cfg));
+                    holes.add(AT(hole, cell), get_hole_weight(t, cfg));
 
                     // used = wish1 | wish2 | ... | wishN
-                    AddOrEquality(cp_model, AT(used, chunk_of_week), impact_for_slot);
+                    AddOrEquality(cp_model, AT(used, cell), impact_for_slot);
 
                     // hole == ~used & usage_before & usage_after
-                    AddAndEquality(cp_model, AT(hole, chunk_of_week), {AT(used, chunk_of_week).Not(), AT(usage_before, chunk_of_week), AT(usage_after, chunk_of_week)});
+                    AddAndEquality(cp_model, AT(hole, cell), {AT(used, cell).Not(), AT(usage_before, cell), AT(usage_after, cell)});
                 }
             }
             for (unsigned day{}; day < 7; ++day) {
                 auto& [first, last, found] = AT(first_last_info_per_day, day);
                 if (!found) {
-                    #ifdef DEBUG
-                    fmt::println("{}: no used slots", Day(day));
-                    #endif
+                    if constexpr (build_mode::trace)
+                        fmt::println("{}: no used slots", Day(day));
 
                     continue;
                 }
 
-                #ifdef DEBUG
-                fmt::println("{}: first={:t}, last={:t} ({} slots)", Day(day), Time(first), Time(last), last - first + 1);
-                #endif
-
-                {
-                    std::vector<BoolVar> rest_of_day_before{};
-                    for (unsigned chunk_of_day{first}; chunk_of_day <= last; ++chunk_of_day) {
-                        auto& ub = AT(usage_before, chunk_of_day);
-                        if (!rest_of_day_before.empty() && ub != FalseVar)
-                            AddOrEquality(cp_model, ub, rest_of_day_before);
-                        auto& u = AT(used, chunk_of_day);
-                        if (u != FalseVar)
-                            rest_of_day_before.push_back(u);
+                if constexpr (build_mode::trace)
+                    fmt::println("{}: first={:t}, last={:t} ({} cells)", Day(day), Time(first * chunks_per_cell(cfg)), Time(last * chunks_per_cell(cfg)), last - first + 1);
+
+                switch (cfg.hole_encoding) {
+                case HoleEncoding::PREFIX:
+                    // usage_before/usage_after are the disjunction of all used cells before/after.
+                    // quadratic in the number of used cells of the day.
+                    {
+                        std::vector<BoolVar> rest_of_day_before{};
+                        for (unsigned chunk_of_day{first}; chunk_of_day <= last; ++chunk_of_day) {
+                            auto& ub = AT(usage_before, chunk_of_day);
+                            if (!rest_of_day_before.empty() && ub != FalseVar)
+                                AddOrEquality(cp_model, ub, rest_of_day_before);
+                            auto& u = AT(used, chunk_of_day);
+                            if (u != FalseVar)
+                                rest_of_day_before.push_back(u);
+                        }
                     }
-                }
 
-                {
-                    std::vector<BoolVar> rest_of_day_after{};
-                    for (unsigned chunk_of_day{last}; chunk_of_day >= first; --chunk_of_day) {
-                        auto& ua = AT(usage_after, chunk_of_day);
-                        if (!rest_of_day_after.empty() && ua != FalseVar)
-                            AddOrEquality(cp_model, AT(usage_after, chunk_of_day), rest_of_day_after);
-                        auto& u = AT(used, chunk_of_day);
-                        if (u != FalseVar)
-                            rest_of_day_after.push_back(u);
+                    {
+                        std::vector<BoolVar> rest_of_day_after{};
+                        for (unsigned chunk_of_day{last}; chunk_of_day >= first; --chunk_of_day) {
+                            auto& ua = AT(usage_after, chunk_of_day);
+                            if (!rest_of_day_after.empty() && ua != FalseVar)
+                                AddOrEquality(cp_model, AT(usage_after, chunk_of_day), rest_of_day_after);
+                            auto& u = AT(used, chunk_of_day);
+                            if (u != FalseVar)
+                                rest_of_day_after.push_back(u);
+                        }
                     }
+                    break;
+
+                case HoleEncoding::CHAIN:
+                    // usage_before is derived from the previous used cell only:
+                    // usage_before(t) = usage_before(p) | used(p), and usage_after the same way in reverse.
+                    // linear in the number of used cells of the day.
+                    constraint_usage_chain(cp_model, usage_before, first, last, 1);
+                    constraint_usage_chain(cp_model, usage_after, last, first, -1);
+                    break;
+                }
+            }
+        }
+
+        // the holes of the interval encoding: per day, the weights of the cells from the first start to the last
+        // end minus the weights of the cells blocked by lessons. as in "constraint_minimize_holes", only cells which
+        // a lesson can cover have a weight. the weights are looked up in their prefix sums over the cells of the day,
+        // so the lunch break needs nothing extra.
+        void constraint_minimize_holes_intervals(CpModelBuilder& cp_model,
+                                                 objective_terms& holes,
+                                                 const struct solve_config& cfg) {
+            first_last_info_per_day = {};
+
+            const unsigned cells = cells_per_day(cfg);
+            std::vector<bool> covered(cells_per_week(cfg) + cells);
+            for (const auto& student : students)
+                for (const auto& window : student.get_windows())
+                    for (const auto start : window.starts)
+                        std::fill_n(covered.begin() + window.get_first_cell() + start, student.get_lesson_cells(cfg), true);
+
+            // a lesson may end after midnight, so the ends go up to the end of the next day
+            const unsigned span_cells = 2 * cells;
+            for (unsigned day{}; day < 7; ++day) {
+                std::vector<std::pair<const Student::window*, unsigned>> day_windows;
+                for (const auto& student : students)
+                    for (const auto& window : student.get_windows())
+                        if (window.day == day)
+                            day_windows.emplace_back(&window, student.get_lesson_cells(cfg));
+                if (day_windows.empty())
+                    continue;
+
+                std::vector<int64_t> weight_before(span_cells + 1);
+                int64_t weight_range{};
+                for (unsigned cell{}; cell < span_cells; ++cell) {
+                    const unsigned cell_of_week = day * cells + cell;
+                    const int64_t weight = cell < cells && covered[cell_of_week] ? get_hole_weight(Time(cell_of_week * chunks_per_cell(cfg)), cfg) : 0;
+                    weight_before[cell + 1] = weight_before[cell] + weight;
+                    weight_range += std::abs(weight);
+                }
+                const Domain weight_domain(-weight_range, weight_range);
+                const Domain cell_domain(0, span_cells);
+
+                std::vector<BoolVar> presents;
+                std::vector<LinearExpr> firsts, lasts;
+                for (const auto& [window, lesson_cells] : day_windows) {
+                    presents.push_back(window->present);
+
+                    // an absent lesson moves neither the first start nor the last end
+                    const auto first = cp_model.NewIntVar(cell_domain);
+                    cp_model.AddEquality(first, window->start).OnlyEnforceIf(window->present);
+                    cp_model.AddEquality(first, int64_t(span_cells)).OnlyEnforceIf(window->present.Not());
+                    firsts.push_back(first);
+                    const auto last = cp_model.NewIntVar(cell_domain);
+                    cp_model.AddEquality(last, window->start + int64_t(lesson_cells)).OnlyEnforceIf(window->present);
+                    cp_model.AddEquality(last, int64_t(0)).OnlyEnforceIf(window->present.Not());
+                    lasts.push_back(last);
+
+                    // weights of the cells blocked by the lesson, per start
+                    std::vector<int64_t> blocked(span_cells);
+                    for (unsigned start{}; start < span_cells; ++start)
+                        blocked[start] = weight_before[std::min(start + lesson_cells, span_cells)] - weight_before[start];
+                    const auto blocked_weight = cp_model.NewIntVar(weight_domain);
+                    cp_model.AddElement(window->start, blocked, blocked_weight);
+                    const auto used_weight = cp_model.NewIntVar(weight_domain);
+                    cp_model.AddEquality(used_weight, blocked_weight).OnlyEnforceIf(window->present);
+                    cp_model.AddEquality(used_weight, int64_t(0)).OnlyEnforceIf(window->present.Not());
+                    holes.add(used_weight, -1, -weight_range, weight_range);
                 }
+
+                const auto day_used = named(cp_model.NewBoolVar(), "used {}", Day(day));
+                AddOrEquality(cp_model, day_used, presents);
+                const auto first = named(cp_model.NewIntVar(cell_domain), "first start {}", Day(day));
+                const auto last = named(cp_model.NewIntVar(cell_domain), "last end {}", Day(day));
+                cp_model.AddMinEquality(first, firsts);
+                cp_model.AddMaxEquality(last, lasts);
+
+                const auto weight_first = cp_model.NewIntVar(weight_domain);
+                const auto weight_last = cp_model.NewIntVar(weight_domain);
+                cp_model.AddElement(first, weight_before, weight_first);
+                cp_model.AddElement(last, weight_before, weight_last);
+                const auto span_weight = named(cp_model.NewIntVar(Domain(-2 * weight_range, 2 * weight_range)), "span {}", Day(day));
+                cp_model.AddEquality(span_weight, weight_last - weight_first).OnlyEnforceIf(day_used);
+                cp_model.AddEquality(span_weight, int64_t(0)).OnlyEnforceIf(day_used.Not());
+                holes.add(span_weight, 1, -2 * weight_range, 2 * weight_range);
             }
         }
 
+        // the input time is measured by the caller and kept, all other statistics start over
         bool schedule(const struct solve_config& cfg) {
-            CpModelBuilder cp_model;
+            const auto input_time = statistics[Phase::INPUT];
+            statistics = solve_statistics{};
+            statistics[Phase::INPUT] = input_time;
+            alternatives.clear();
+            schedule_begin = std::chrono::steady_clock::now();
+            reported_objective.reset();
 
-            std::vector<BoolVar> objective_var;
-            std::vector<int64_t> objective_prio;
-            bool objective{false};
+            bool success;
+            {
+                PhaseTimer timer(statistics[Phase::TOTAL], CLOCK_PROCESS_CPUTIME_ID);
+                success = schedule_cached(cfg, [&] { return schedule_with_mode(cfg); });
+            }
+            statistics.best_objective_bound = best_objective_bound;
+            statistics.gap = gap;
+            return success;
+        }
 
-            std::vector<std::list<std::tuple<BoolVar, unsigned>>> wishes(slots_per_week);
-            for (auto& student : students)
-                student.calculate_availabilities(cp_model, wishes, cfg);
+        // takes the schedule from the cache if it is there, otherwise runs "solve" and caches an optimal result
+        // of the solver. used for the whole plan and for every component, so that a changed student only costs
+        // the solve of its own component.
+        template <typename Solve>
+        bool schedule_cached(const struct solve_config& cfg, Solve&& solve) {
+            cached_solution = false;
+            // the cache only keeps the best schedule
+            if (!cache || cfg.alternatives)
+                return solve();
+
+            const auto key = get_input_hash(cfg);
+            if (const auto cached = cache->find(key); cached && use_cached_result(*cached)) {
+                ++statistics.cache_hits;
+                return true;
+            }
+            ++statistics.cache_misses;
+
+            const bool success = solve();
+            if (success && status == CpSolverStatus::OPTIMAL && !heuristic_solution)
+                cache->insert(key, make_cached_result());
+            return success;
+        }
+
+        cached_result make_cached_result() const {
+            cached_result cached;
+            cached.objective_value = objective_value;
+            cached.best_objective_bound = best_objective_bound;
+            for (const auto& [start, end, student] : result)
+                cached.lessons.emplace_back(student - students.data(), start.get_chunk_of_week());
+            for (const auto* student : skipped)
+                cached.skipped.push_back(student - students.data());
+            return cached;
+        }
+
+        // false, and nothing changes, if "cached" does not fit the students (a corrupt entry or a hash collision):
+        // every student has to be in it exactly once, and every start has to be within the week
+        bool use_cached_result(const cached_result& cached) {
+            if (cached.lessons.size() + cached.skipped.size() != students.size())
+                return false;
+            std::vector<bool> seen(students.size());
+            const auto first_seen = [&](size_t index) {
+                if (index >= seen.size() || seen[index])
+                    return false;
+                seen[index] = true;
+                return true;
+            };
+            for (const auto& [index, start] : cached.lessons)
+                if (!first_seen(index) || start >= slots_per_week)
+                    return false;
+            for (const auto index : cached.skipped)
+                if (!first_seen(index))
+                    return false;
+
+            result.clear();
+            skipped.clear();
+            for (const auto& [index, start] : cached.lessons) {
+                const auto& student = AT(students, index);
+                result.emplace_back(Time(start), Time(start) + student.get_lesson_chunks(), &student);
+            }
+            for (const auto index : cached.skipped)
+                skipped.push_back(&AT(students, index));
+            feasibility = feasibility_report{};
+            heuristic_solution = false;
+            cached_solution = true;
+            status = CpSolverStatus::OPTIMAL;
+            objective_value = cached.objective_value;
+            best_objective_bound = cached.best_objective_bound;
+            gap = std::abs(objective_value - best_objective_bound) / std::max(1.0, std::abs(objective_value));
+            statistics.best_objective_bound = best_objective_bound;
+            statistics.gap = gap;
+            return true;
+        }
+
+        bool schedule_with_mode(const struct solve_config& cfg) {
+            if (cfg.solve_mode == SolveMode::EXACT)
+                return schedule_exact(cfg);
+
+            const bool heuristic_found = schedule_heuristic(cfg);
+            if (cfg.solve_mode == SolveMode::HEURISTIC)
+                return heuristic_found;
+
+            // the heuristic schedule guides the solver, unless the caller already provided a hint
+            const bool own_hint = heuristic_found && hint.empty();
+            if (own_hint)
+                for (const auto& [start, end, student] : result)
+                    hint.emplace_back(student->get_id(), start);
+
+            const bool exact_found = schedule_exact(cfg);
+            if (own_hint)
+                hint.clear();
+            if (exact_found)
+                return true;
+
+            // the solver ran out of time without a solution of its own: fall back to the heuristic one
+            if (heuristic_found && status != CpSolverStatus::INFEASIBLE)
+                return schedule_heuristic(cfg);
+            return false;
+        }
+
+        // greedy placement plus local search, see "Heuristic". there is no bound, so the gap is reported as 1.
+        bool schedule_heuristic(const struct solve_config& cfg) {
+            assign_anchors(cfg);
+            PhaseTimer solve_timer(statistics[Phase::SOLVE]);
+            std::vector<heuristic_student> heuristic_students;
+            heuristic_students.reserve(students.size());
+            for (const auto& student : students) {
+                auto& heuristic_student = heuristic_students.emplace_back(student.get_lesson_cells(cfg), student.get_student_prio());
+                for (const auto& [t, availability_index] : student.get_candidates(cfg))
+                    heuristic_student.candidates.emplace_back(t, student.get_wish_prio(availability_index));
+            }
+
+            Heuristic heuristic(heuristic_students, cfg);
+            heuristic_solution = true;
+            skipped.clear();
+            result.clear();
+            if (!heuristic.run()) {
+                status = CpSolverStatus::UNKNOWN;
+                return false;
+            }
+            solve_timer.stop();
+
+            PhaseTimer extraction_timer(statistics[Phase::EXTRACTION]);
+
+            const auto& assignment = heuristic.get_assignment();
+            for (size_t index{}; index < students.size(); ++index) {
+                const auto& student = AT(students, index);
+                if (!assignment[index]) {
+                    skipped.push_back(&student);
+                    continue;
+                }
+                const auto start = heuristic_students[index].candidates[*assignment[index]].start;
+                result.emplace_back(start, start + student.get_lesson_chunks(), &student);
+            }
+
+            status = CpSolverStatus::FEASIBLE;
+            objective_value = heuristic.get_objective();
+            best_objective_bound = std::numeric_limits<double>::lowest();
+            gap = 1;
+            if (progress)
+                report(incumbent{objective_value, best_objective_bound, elapsed(), result, skipped});
+
+            if constexpr (print_stats)
+                fmt::println("heuristic: objective {}, {} skipped", objective_value, skipped.size());
+            return true;
+        }
+
+        bool schedule_exact(const struct solve_config& cfg) {
+            heuristic_solution = false;
+            // the alternatives of the components would have to be combined
+            if (cfg.decompose && !cfg.alternatives) {
+                const auto components = find_components(cfg);
+                if constexpr (print_stats)
+                    fmt::println("{} independent component(s)", components.size());
+                if (components.size() > 1)
+                    return schedule_components(components, cfg);
+            }
+            return schedule_refined(cfg);
+        }
+
+        // with "coarse_granularity", solves on the coarse cells first and then on the fine ones, every student
+        // restricted to the starts within one coarse cell of its coarse start and hinted with it. a student skipped
+        // on the coarse cells keeps all candidates. if the coarse model finds nothing, or the restriction makes the
+        // fine one infeasible, the fine model is solved without restriction. the coarse solve gets half of the time.
+        // the optimum and the bound of the restricted fine model do not hold for the whole one, so its schedule is
+        // only feasible, has no bound (as the heuristic one) and does not go into the cache.
+        bool schedule_refined(const struct solve_config& cfg) {
+            if (!cfg.coarse_granularity || cfg.coarse_granularity == cfg.time_granularity)
+                return schedule_model(cfg);
+
+            const auto begin = std::chrono::steady_clock::now();
+            struct solve_config coarse_cfg = cfg;
+            coarse_cfg.time_granularity = cfg.coarse_granularity;
+            coarse_cfg.coarse_granularity = 0;
+            coarse_cfg.alternatives = 0;
+            coarse_cfg.max_time_in_seconds = cfg.max_time_in_seconds / 2;
+
+            struct solve_config fine_cfg = cfg;
+            const auto remaining_time = [&] {
+                if (cfg.max_time_in_seconds > 0)
+                    fine_cfg.max_time_in_seconds = std::max(cfg.max_time_in_seconds / 10,
+                        cfg.max_time_in_seconds - std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count());
+            };
+
+            if (!schedule_model(coarse_cfg)) {
+                if constexpr (print_stats)
+                    fmt::println("coarse ({} min): {}, solving on {} min cells only", cfg.coarse_granularity, get_status_name(), cfg.time_granularity);
+                remaining_time();
+                return schedule_model(fine_cfg);
+            }
+
+            if constexpr (print_stats)
+                fmt::println("coarse ({} min): {} {}", cfg.coarse_granularity, get_status_name(), objective_value);
+
+            const unsigned radius = cfg.coarse_granularity / MIN_ALIGNMENT;
+            const bool own_hint = hint.empty();
+            for (const auto& [start, end, student] : result) {
+                const unsigned from = start.get_chunk_of_week() - std::min(start.get_chunk_of_week(), radius);
+                AT(students, student - students.data()).set_focus(std::pair(Time(from), start + radius));
+                if (own_hint)
+                    hint.emplace_back(student->get_id(), start);
+            }
+
+            remaining_time();
+            bool success = schedule_model(fine_cfg);
             for (auto& student : students)
-                student.register_conflicts(cp_model, wishes);
+                student.set_focus(std::nullopt);
+            if (success) {
+                status = CpSolverStatus::FEASIBLE;
+                best_objective_bound = std::numeric_limits<double>::lowest();
+                gap = 1;
+                for (auto& alternative : alternatives)
+                    alternative.optimal = false;
+            } else if (status == CpSolverStatus::INFEASIBLE) {
+                if constexpr (print_stats)
+                    fmt::println("no schedule near the coarse one, solving on {} min cells without restriction", cfg.time_granularity);
+                remaining_time();
+                success = schedule_model(fine_cfg);
+            }
+            if (own_hint)
+                hint.clear();
+            return success;
+        }
 
-            if (cfg.minimize_wishes_prio) {
-                for (const auto& l : wishes) {
-                    for (const auto& [var, prio] : l) {
-                        objective_var.push_back(var);
-                        objective_prio.push_back(prio);
+        // groups students (by index) which share a constraint. without hole minimization that is an overlap of
+        // their coverage, with it any two students who could both be scheduled on the same day are coupled.
+        // every component keeps the union of its students' coverage, and a student joins (and thereby merges)
+        // all components whose coverage it intersects.
+        std::vector<std::vector<size_t>> find_components(const struct solve_config& cfg) const {
+            std::vector<std::vector<size_t>> components;
+            std::vector<WeekMask> component_masks;
+            for (size_t index{}; index < students.size(); ++index) {
+                auto mask = AT(students, index).get_coverage_mask(cfg);
+                if (cfg.minimize_holes)
+                    mask = mask.expand_to_days();
+
+                std::optional<size_t> target;
+                for (size_t component{}; component < components.size();) {
+                    if (!component_masks[component].intersects(mask)) {
+                        ++component;
+                    } else if (!target) {
+                        target = component++;
+                    } else {
+                        // "target" is always in front of "component", so moving the last entry here keeps it valid
+                        component_masks[*target] |= component_masks[component];
+                        components[*target].insert(components[*target].end(), components[component].begin(), components[component].end());
+                        if (component + 1 != components.size()) {
+                            component_masks[component] = component_masks.back();
+                            components[component] = std::move(components.back());
+                        }
+                        component_masks.pop_back();
+                        components.pop_back();
                     }
                 }
-                objective = true;
+
+                if (!target) {
+                    target = components.size();
+                    components.emplace_back();
+                    component_masks.emplace_back();
+                }
+                component_masks[*target] |= mask;
+                components[*target].push_back(index);
             }
-            if (cfg.allow_skip) {
-                for (auto& student : students) {
-                    objective_var.push_back(student.get_skip_var());
-                    objective_prio.push_back(cfg.skip_prio);
+
+            for (auto& component : components)
+                std::sort(component.begin(), component.end());
+            std::sort(components.begin(), components.end());
+            return components;
+        }
+
+        // solves every component as its own model concurrently and merges the partial schedules
+        bool schedule_components(const std::vector<std::vector<size_t>>& components, const struct solve_config& cfg) {
+            std::vector<Plan> plans;
+            plans.reserve(components.size());
+            for (const auto& component : components) {
+                std::vector<Student> component_students;
+                component_students.reserve(component.size());
+                for (const auto index : component)
+                    component_students.push_back(AT(students, index));
+                auto& plan = plans.emplace_back(std::move(component_students));
+                plan.hint = hint;
+                plan.stop = stop;
+                plan.cache = cache;
+            }
+
+            // split the solver workers between the concurrently running components
+            const unsigned hardware_threads = std::max(1u, std::thread::hardware_concurrency());
+            const unsigned thread_count = std::min<size_t>(plans.size(), hardware_threads);
+            struct solve_config component_cfg = cfg;
+            component_cfg.decompose = false;
+            component_cfg.num_workers = std::max(1u, (cfg.num_workers ? cfg.num_workers : hardware_threads) / thread_count);
+
+            // every component reports its incumbents here. once each has one, their combination is reported.
+            std::mutex progress_mutex;
+            std::vector<std::optional<incumbent>> latest(plans.size());
+            if (progress) {
+                for (size_t i{}; i < plans.size(); ++i) {
+                    plans[i].set_progress_callback([&, i](const incumbent& found) {
+                        std::lock_guard lock(progress_mutex);
+                        latest[i] = found;
+                        if (std::any_of(latest.begin(), latest.end(), [](const auto& component) { return !component; }))
+                            return;
+                        incumbent combined{.objective_value = 0, .best_objective_bound = 0, .time = elapsed(), .result = {}, .skipped = {}};
+                        for (size_t j{}; j < plans.size(); ++j) {
+                            const auto original = [&](const Student* student) {
+                                return &AT(students, AT(AT(components, j), student - plans[j].students.data()));
+                            };
+                            combined.objective_value += latest[j]->objective_value;
+                            combined.best_objective_bound += latest[j]->best_objective_bound;
+                            for (const auto& [start, end, student] : latest[j]->result)
+                                combined.result.emplace_back(start, end, original(student));
+                            for (const auto* student : latest[j]->skipped)
+                                combined.skipped.push_back(original(student));
+                        }
+                        std::sort(combined.result.begin(), combined.result.end(), [](const auto& a, const auto& b) { return a.student < b.student; });
+                        std::sort(combined.skipped.begin(), combined.skipped.end());
+                        report(std::move(combined));
+                    });
                 }
             }
 
-            if (cfg.minimize_holes) {
-                constraint_minimize_holes(cp_model, objective_var, objective_prio, cfg);
-                objective = true;
+            std::vector<bool> success(plans.size());
+            const double cpu_begin = PhaseTimer::cpu_now(CLOCK_PROCESS_CPUTIME_ID);
+            {
+                ThreadPool pool(thread_count);
+                std::vector<std::future<bool>> futures;
+                for (auto& plan : plans)
+                    futures.push_back(pool.submit([&plan, &component_cfg] {
+                        return plan.schedule_cached(component_cfg, [&] { return plan.schedule_refined(component_cfg); });
+                    }));
+                for (size_t i{}; i < futures.size(); ++i)
+                    success[i] = futures[i].get();
             }
 
-            if (objective) {
-                auto prio_sum = LinearExpr::WeightedSum(objective_var, objective_prio);
-                cp_model.Minimize(prio_sum);
+            // the wall times of the components add up although they ran concurrently. the solve CPU time of each
+            // component is the one of the whole process and includes the others, so it is replaced by what remains
+            // of the process CPU time after the model building phases.
+            double build_cpu{};
+            for (const auto& plan : plans) {
+                statistics += plan.statistics;
+                for (const auto phase : {Phase::PRECHECK, Phase::VARIABLES, Phase::CONFLICTS, Phase::HOLES, Phase::EXTRACTION})
+                    build_cpu += plan.statistics[phase].cpu;
             }
+            statistics[Phase::SOLVE].cpu = std::max(0.0, PhaseTimer::cpu_now(CLOCK_PROCESS_CPUTIME_ID) - cpu_begin - build_cpu);
 
-            CpSolverResponse response;
-            if constexpr (enumerate_all_solutions) {
-                Model model;
-                SatParameters parameters;
-                parameters.set_linearization_level(0);
-                parameters.set_enumerate_all_solutions(true);
-                model.Add(NewSatParameters(parameters));
-
-                unsigned solution_count{};
-                model.Add(NewFeasibleSolutionObserver([&](const CpSolverResponse& resp) {
-                    fmt::println("SOLUTION {}", ++solution_count);
-                    for (auto& student : students) {
-                        if (cfg.allow_skip && student.is_skipped(resp)) {
-                            fmt::println("SKIPPED {}", student.get_name());
+            feasibility = feasibility_report{};
+            for (size_t i{}; i < plans.size(); ++i) {
+                const auto& component_feasibility = plans[i].feasibility;
+                feasibility.feasible &= component_feasibility.feasible;
+                feasibility.min_skipped += component_feasibility.min_skipped;
+                for (const auto index : component_feasibility.conflicting)
+                    feasibility.conflicting.push_back(AT(AT(components, i), index));
+            }
+            std::sort(feasibility.conflicting.begin(), feasibility.conflicting.end());
+
+            status = CpSolverStatus::OPTIMAL;
+            objective_value = best_objective_bound = 0;
+            bool bounded{true};
+            for (size_t i{}; i < plans.size(); ++i) {
+                if (!success[i]) {
+                    status = plans[i].status;
+                    return false;
+                }
+                if (plans[i].status != CpSolverStatus::OPTIMAL)
+                    status = CpSolverStatus::FEASIBLE;
+                objective_value += plans[i].objective_value;
+                best_objective_bound += plans[i].best_objective_bound;
+                // a component without a bound (a refined one) leaves the whole plan without one
+                bounded &= plans[i].best_objective_bound != std::numeric_limits<double>::lowest();
+            }
+            gap = std::abs(objective_value - best_objective_bound) / std::max(1.0, std::abs(objective_value));
+            if (!bounded) {
+                best_objective_bound = std::numeric_limits<double>::lowest();
+                gap = 1;
+            }
+
+            // map the students of the component plans back to ours, keeping the order of the students
+            std::vector<bool> skipped_per_student(students.size());
+            std::vector<std::optional<schedule_result>> result_per_student(students.size());
+            for (size_t i{}; i < plans.size(); ++i) {
+                const auto& component = AT(components, i);
+                const auto original = [&](const Student* student) {
+                    return AT(component, student - plans[i].students.data());
+                };
+                for (const auto* student : plans[i].skipped)
+                    skipped_per_student[original(student)] = true;
+                for (const auto& [start, end, student] : plans[i].result)
+                    result_per_student[original(student)] = schedule_result{start, end, &AT(students, original(student))};
+            }
+            skipped.clear();
+            result.clear();
+            for (size_t index{}; index < students.size(); ++index) {
+                if (skipped_per_student[index])
+                    skipped.push_back(&students[index]);
+                if (result_per_student[index])
+                    result.push_back(*result_per_student[index]);
+            }
+
+            return true;
+        }
+
+        // runs the flow relaxation of "check_feasibility" on the candidates of all students
+        void precheck(const struct solve_config& cfg) {
+            PhaseTimer timer(statistics[Phase::PRECHECK]);
+            std::vector<feasibility_demand> demands;
+            demands.reserve(students.size());
+            for (const auto& student : students)
+                demands.emplace_back(student.get_lesson_cells(cfg) * chunks_per_cell(cfg), student.get_candidate_mask(cfg));
+            feasibility = check_feasibility(demands);
+
+            if constexpr (print_stats)
+                if (!feasibility.feasible)
+                    fmt::println("precheck: {} students compete for too few chunks, at least {} need to be skipped",
+                        feasibility.conflicting.size(), feasibility.min_skipped);
+        }
+
+        // one run of CP-SAT on "proto"; "time_limit" in seconds, 0 = none
+        CpSolverResponse solve_proto(const CpModelProto& proto, const struct solve_config& cfg, double time_limit, bool first_solution = false) {
+            Model model;
+            SatParameters parameters;
+            if (time_limit > 0)
+                parameters.set_max_time_in_seconds(time_limit);
+            if (first_solution)
+                parameters.set_stop_after_first_solution(true);
+            if (cfg.relative_gap_limit > 0)
+                parameters.set_relative_gap_limit(cfg.relative_gap_limit);
+            if (cfg.repair_hint && !hint.empty())
+                parameters.set_repair_hint(true);
+            if (cfg.num_workers)
+                parameters.set_num_workers(cfg.num_workers);
+
+            if (progress)
+                model.Add(NewFeasibleSolutionObserver([&](const CpSolverResponse& response) { report_incumbent(response, cfg); }));
+
+            model.Add(NewSatParameters(parameters));
+            if (stop)
+                model.GetOrCreate<TimeLimit>()->RegisterExternalBooleanAsLimit(stop);
+            const CpSolverResponse response = SolveCpModel(proto, &model);
+
+            statistics.conflicts += response.num_conflicts();
+            statistics.branches += response.num_branches();
+
+            if constexpr (print_stats)
+                fmt::print("{}", CpSolverResponseStats(response));
+
+            return response;
+        }
+
+        static constexpr double lns_round_seconds = 1.0;
+        static constexpr unsigned lns_stale_rounds = 20;
+        static constexpr size_t lns_min_students = 8;
+        static constexpr unsigned lns_band_hours = 3;
+
+        // students (by index) who may move in one sub-model: those who could have a lesson on a random day, in a
+        // random time band of every day, or who overlap, transitively, with a random student. at most a quarter
+        // of the students (but "lns_min_students"), chosen at random if there are more.
+        std::vector<size_t> lns_neighbourhood(std::mt19937_64& random, const std::vector<WeekMask>& coverage) const {
+            constexpr unsigned chunks_per_day = 24 * 60 / MIN_ALIGNMENT;
+            const size_t limit = std::max(lns_min_students, students.size() / 4);
+            std::vector<size_t> freed;
+
+            const auto free_overlapping = [&](const WeekMask& mask) {
+                for (size_t index{}; index < students.size(); ++index)
+                    if (coverage[index].intersects(mask))
+                        freed.push_back(index);
+            };
+
+            switch (random() % 3) {
+            case 0: {
+                const unsigned day = random() % 7;
+                WeekMask mask;
+                mask.set_range(Time(day * chunks_per_day), Time((day + 1) * chunks_per_day));
+                free_overlapping(mask);
+                break;
+            }
+            case 1: {
+                const unsigned hour = random() % (24 - lns_band_hours + 1);
+                WeekMask mask;
+                for (unsigned day{}; day < 7; ++day)
+                    mask.set_range(Time(Day(day), hour, 0), Time(day * chunks_per_day + (hour + lns_band_hours) * 60 / MIN_ALIGNMENT));
+                free_overlapping(mask);
+                break;
+            }
+            default: {
+                std::vector<bool> taken(students.size());
+                freed.push_back(random() % students.size());
+                taken[freed.front()] = true;
+                for (size_t next{}; next < freed.size() && freed.size() < limit; ++next)
+                    for (size_t index{}; index < students.size() && freed.size() < limit; ++index)
+                        if (!taken[index] && coverage[index].intersects(coverage[freed[next]])) {
+                            taken[index] = true;
+                            freed.push_back(index);
+                        }
+                break;
+            }
+            }
+
+            if (freed.size() > limit) {
+                std::shuffle(freed.begin(), freed.end(), random);
+                freed.resize(limit);
+            }
+            return freed;
+        }
+
+        // large neighbourhood search on the built model. starts from the first solution, which a complete hint
+        // (like the heuristic schedule) provides right away. every round solves sub-models in parallel in which the
+        // students of one neighbourhood may move and everyone else is fixed to the current lesson, and takes over
+        // the best improvement. ends at the time limit, on "stop", or after "lns_stale_rounds" rounds without an
+        // improvement. the bound is the one of the first solve, so the status stays FEASIBLE.
+        CpSolverResponse solve_lns(const CpModelBuilder& cp_model, const struct solve_config& cfg) {
+            const auto begin = std::chrono::steady_clock::now();
+            const auto elapsed = [&] { return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count(); };
+            const auto remaining = [&] {
+                return cfg.max_time_in_seconds > 0 ? cfg.max_time_in_seconds - elapsed() : std::numeric_limits<double>::infinity();
+            };
+
+            const auto proto = cp_model.Build();
+            auto best = solve_proto(proto, cfg, cfg.max_time_in_seconds, true);
+            status = best.status();
+            objective_value = best.objective_value();
+            best_objective_bound = best.best_objective_bound();
+            if (status != CpSolverStatus::FEASIBLE)
+                return best;
+            const double first_objective = objective_value;
+            statistics.trace.emplace_back(elapsed(), first_objective);
+
+            std::vector<std::vector<int>> decision_vars;
+            std::vector<WeekMask> coverage;
+            for (const auto& student : students) {
+                decision_vars.push_back(student.get_decision_vars(cfg));
+                coverage.push_back(student.get_coverage_mask(cfg));
+            }
+
+            const unsigned parallel = std::max(1u, cfg.num_workers ? cfg.num_workers : std::thread::hardware_concurrency());
+            std::mt19937_64 random(students.size());
+            ThreadPool pool(parallel);
+            unsigned rounds{}, stale{};
+            for (; stale < lns_stale_rounds && remaining() > 0 && !(stop && *stop); ++rounds) {
+                const double time_limit = std::min(lns_round_seconds, remaining());
+
+                std::vector<CpModelProto> neighbourhoods;
+                for (unsigned i{}; i < parallel; ++i) {
+                    std::vector<bool> freed(students.size());
+                    for (const auto index : lns_neighbourhood(random, coverage))
+                        freed[index] = true;
+
+                    auto& neighbourhood = neighbourhoods.emplace_back(proto);
+                    for (size_t index{}; index < students.size(); ++index) {
+                        if (freed[index])
                             continue;
+                        for (const auto var : decision_vars[index]) {
+                            auto& domain = *neighbourhood.mutable_variables(var);
+                            domain.clear_domain();
+                            domain.add_domain(best.solution(var));
+                            domain.add_domain(best.solution(var));
                         }
-                        const auto start = student.get_solution_time(resp);
-                        const auto end = start + student.get_lesson_chunks();
-                        fmt::println("{} - {}: {} ({})", start, end, student.get_name(), student.get_priority(start) + 1);
                     }
-                }));
-                response = SolveCpModel(cp_model.Build(), &model);
-            } else {
-                response = Solve(cp_model.Build());
+                    neighbourhood.clear_solution_hint();
+                    auto& solution_hint = *neighbourhood.mutable_solution_hint();
+                    for (int var{}; var < neighbourhood.variables_size(); ++var) {
+                        solution_hint.add_vars(var);
+                        solution_hint.add_values(best.solution(var));
+                    }
+                }
+
+                std::vector<std::future<CpSolverResponse>> futures;
+                for (const auto& neighbourhood : neighbourhoods)
+                    futures.push_back(pool.submit([this, &neighbourhood, time_limit] { return solve_neighbourhood(neighbourhood, time_limit); }));
+
+                std::optional<CpSolverResponse> improved;
+                for (auto& future : futures) {
+                    auto response = future.get();
+                    statistics.conflicts += response.num_conflicts();
+                    statistics.branches += response.num_branches();
+                    const double threshold = improved ? improved->objective_value() : best.objective_value();
+                    if ((response.status() == CpSolverStatus::OPTIMAL || response.status() == CpSolverStatus::FEASIBLE) &&
+                        response.objective_value() < threshold)
+                        improved = std::move(response);
+                }
+
+                if (!improved) {
+                    ++stale;
+                    continue;
+                }
+                stale = 0;
+                best = std::move(*improved);
+                statistics.trace.emplace_back(elapsed(), best.objective_value());
+                report_incumbent(best, cfg);
             }
 
+            objective_value = best.objective_value();
             if constexpr (print_stats)
-                fmt::print("{}", CpSolverResponseStats(response));
+                fmt::println("lns: {} rounds of {} neighbourhoods, objective {} -> {} after {:.3f}s",
+                    rounds, parallel, first_objective, objective_value, elapsed());
+            return best;
+        }
 
-            if (response.status() != CpSolverStatus::OPTIMAL)
-                return false;
+        // one sub-model of "solve_lns", on a single worker
+        CpSolverResponse solve_neighbourhood(const CpModelProto& proto, double time_limit) const {
+            Model model;
+            SatParameters parameters;
+            parameters.set_max_time_in_seconds(time_limit);
+            parameters.set_num_workers(1);
+            model.Add(NewSatParameters(parameters));
+            if (stop)
+                model.GetOrCreate<TimeLimit>()->RegisterExternalBooleanAsLimit(stop);
+            return SolveCpModel(proto, &model);
+        }
 
-#ifdef DEBUG
-            for (unsigned day{}; day < 7; ++day) {
-                const auto& [first, last, found] = AT(first_last_info_per_day, day);
-                if (!found)
+        // groups of at least two interchangeable students (see "Student::get_symmetry_key"), as indices. a group is
+        // ordered by the hinted starts, so that the hint stays a solution, with the students without a hint (which
+        // may be skipped) first and otherwise in input order.
+        std::vector<std::vector<size_t>> find_symmetry_classes(const struct solve_config& cfg) const {
+            std::map<std::vector<int64_t>, std::vector<size_t>> by_key;
+            for (size_t index{}; index < students.size(); ++index)
+                by_key[AT(students, index).get_symmetry_key(cfg)].push_back(index);
+
+            std::unordered_map<unsigned, unsigned> hinted_start;
+            for (const auto& [id, start] : hint)
+                hinted_start.emplace(id, start.get_chunk_of_week() + 1);
+            const auto order = [&](size_t index) {
+                const auto it = hinted_start.find(AT(students, index).get_id());
+                return it != hinted_start.end() ? it->second : 0;
+            };
+
+            std::vector<std::vector<size_t>> classes;
+            for (auto& [key, members] : by_key) {
+                if (members.size() < 2)
                     continue;
-                for (unsigned chunk_of_week{first}; chunk_of_week <= last; ++chunk_of_week) {
-                    fmt::println("{}: used={}, usage_before={}, usage_after={}, hole={}",
-                        Time(chunk_of_week),
-                        yon(SolutionIntegerValue(response, AT(used, chunk_of_week))),
-                        yon(SolutionIntegerValue(response, AT(usage_before, chunk_of_week))),
-                        yon(SolutionIntegerValue(response, AT(usage_after, chunk_of_week))),
-                        ymn(SolutionIntegerValue(response, AT(hole, chunk_of_week)), AT(hole, chunk_of_week) == cp_model.FalseVar()));
+                std::stable_sort(members.begin(), members.end(), [&](size_t a, size_t b) { return order(a) < order(b); });
+                classes.push_back(std::move(members));
+            }
+            return classes;
+        }
+
+        // the starts of interchangeable students increase along their group, which leaves one of the permutations
+        // of every schedule. skipped students come first.
+        void constraint_symmetry(CpModelBuilder& cp_model, const struct solve_config& cfg) {
+            for (const auto& members : find_symmetry_classes(cfg)) {
+                ++statistics.symmetry_classes;
+                statistics.symmetric_students += members.size();
+                std::optional<LinearExpr> previous;
+                for (const auto index : members) {
+                    auto order = AT(students, index).add_start_order(cp_model, cfg);
+                    if (previous)
+                        cp_model.AddLessOrEqual(*previous, order);
+                    previous = std::move(order);
                 }
             }
-#endif
 
+            if constexpr (print_stats)
+                if (statistics.symmetry_classes)
+                    fmt::println("symmetry: {} groups of {} interchangeable students", statistics.symmetry_classes, statistics.symmetric_students);
+        }
+
+        // minimizes the parts of the objective one after the other. every stage starts from the solution of the
+        // previous one and keeps the previous objectives at most at the values found, which are the optima unless a
+        // limit stopped a stage. skips are counted, "skip_prio" only weighs them in the reported total objective.
+        // the model is left minimizing the last stage which ran, without a bound on it.
+        // sets "status", "objective_value" and "best_objective_bound"; the latter two are weighted like the single
+        // objective, with the trivial bound for the stages which did not run.
+        CpSolverResponse solve_lexicographic(CpModelBuilder& cp_model,
+                                             const std::array<objective_terms, objective_names.size()>& objective,
+                                             const struct solve_config& cfg) {
+            const std::array<bool, objective_names.size()> enabled = {cfg.allow_skip, cfg.minimize_wishes_prio, cfg.minimize_holes};
+            std::vector<Objective> order;
+            for (const auto part : cfg.objective_order)
+                if (AT(enabled, unsigned(part)))
+                    order.push_back(part);
+            for (unsigned part{}; part < objective_names.size(); ++part)
+                if (enabled[part] && std::find(order.begin(), order.end(), Objective(part)) == order.end())
+                    order.push_back(Objective(part));
+
+            const auto stage_prios = [&](Objective part) {
+                auto prios = AT(objective, unsigned(part)).prios;
+                if (part == Objective::SKIPS)
+                    std::fill(prios.begin(), prios.end(), 1);
+                return prios;
+            };
+            const auto stage_weight = [&](Objective part) -> int64_t { return part == Objective::SKIPS ? cfg.skip_prio : 1; };
+
+            const auto begin = std::chrono::steady_clock::now();
+            std::optional<CpSolverResponse> previous;
+            LinearExpr previous_expr;
+            int64_t previous_value{};
+            std::vector<bool> solved(objective_names.size());
+            status = CpSolverStatus::OPTIMAL;
+            best_objective_bound = 0;
+            for (const auto part : order) {
+                double time_limit{};
+                if (cfg.max_time_in_seconds > 0) {
+                    time_limit = cfg.max_time_in_seconds - std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+                    if (previous && time_limit <= 0)
+                        break;
+                }
+                if (previous && stop && *stop)
+                    break;
+
+                // the bound of a stage is only added once another one follows it
+                if (previous)
+                    cp_model.AddLessOrEqual(previous_expr, previous_value);
+                const auto expr = LinearExpr::WeightedSum(AT(objective, unsigned(part)).vars, stage_prios(part));
+                cp_model.Minimize(expr);
+
+                auto proto = cp_model.Build();
+                if (previous) {
+                    proto.clear_solution_hint();
+                    auto& solution_hint = *proto.mutable_solution_hint();
+                    for (int var{}; var < proto.variables_size(); ++var) {
+                        solution_hint.add_vars(var);
+                        solution_hint.add_values(previous->solution(var));
+                    }
+                }
+
+                stage_statistics stage;
+                stage.objective = part;
+                PhaseTimer timer(stage.time, CLOCK_PROCESS_CPUTIME_ID);
+                auto response = solve_proto(proto, cfg, time_limit);
+                timer.stop();
+
+                if (response.status() != CpSolverStatus::OPTIMAL && response.status() != CpSolverStatus::FEASIBLE) {
+                    if (!previous) {
+                        status = response.status();
+                        return response;
+                    }
+                    // out of time (or interrupted) without a solution of its own: the previous one still stands
+                    break;
+                }
+
+                stage.optimal = response.status() == CpSolverStatus::OPTIMAL;
+                stage.objective_value = response.objective_value();
+                stage.best_objective_bound = response.best_objective_bound();
+                statistics.stages.push_back(stage);
+                if (!stage.optimal)
+                    status = CpSolverStatus::FEASIBLE;
+                best_objective_bound += stage_weight(part) * stage.best_objective_bound;
+                AT(solved, unsigned(part)) = true;
+
+                if constexpr (print_stats)
+                    fmt::println("stage {}: {} {} (bound {}) after {:.3f}s",
+                        objective_names.at(unsigned(part)), CpSolverStatus_Name(response.status()),
+                        stage.objective_value, stage.best_objective_bound, stage.time.wall);
+
+                previous_expr = expr;
+                previous_value = int64_t(std::llround(stage.objective_value));
+                previous = std::move(response);
+            }
+
+            // nothing to minimize
+            if (!previous) {
+                auto response = solve_proto(cp_model.Build(), cfg, cfg.max_time_in_seconds);
+                status = response.status();
+                objective_value = best_objective_bound = 0;
+                return response;
+            }
+
+            // the total is evaluated on the final solution, since not every stage may have run
+            objective_value = 0;
+            for (const auto part : order) {
+                const auto& terms = AT(objective, unsigned(part));
+                objective_value += SolutionIntegerValue(*previous, terms.sum());
+                if (!AT(solved, unsigned(part))) {
+                    status = CpSolverStatus::FEASIBLE;
+                    best_objective_bound += terms.lower_bound;
+                }
+            }
+            return *previous;
+        }
+
+        // cell boundaries (as chunks of the week) at which a lesson may start or end in a schedule without
+        // avoidable holes: the first and the last boundary of every student's coverage, the lunch break edges, and
+        // everything reached from these by adding or subtracting the blocked length of any student's lesson, as
+        // long as it stays next to a covered chunk. a run of adjacent lessons which touches none of these can be
+        // shifted until it does without making the wishes or the holes worse, so some optimum only uses anchors.
+        WeekMask find_anchors(const struct solve_config& cfg) const {
+            const unsigned cell = chunks_per_cell(cfg);
+            WeekMask coverage;
+            std::vector<unsigned> lengths;
+            for (const auto& student : students) {
+                coverage |= student.get_coverage_mask(cfg);
+                lengths.push_back(student.get_lesson_cells(cfg) * cell);
+            }
+            std::sort(lengths.begin(), lengths.end());
+            lengths.erase(std::unique(lengths.begin(), lengths.end()), lengths.end());
+
+            const auto next_to_coverage = [&](unsigned chunk) {
+                return (chunk < slots_per_week && coverage.test(chunk)) || (chunk > 0 && chunk <= slots_per_week && coverage.test(chunk - 1));
+            };
+            WeekMask anchors;
+            std::vector<unsigned> pending;
+            const auto add = [&](unsigned chunk) {
+                if (chunk < slots_per_week && next_to_coverage(chunk) && !anchors.test(chunk)) {
+                    anchors.set(chunk);
+                    pending.push_back(chunk);
+                }
+            };
+
+            for (const auto& student : students) {
+                for (const auto& [first, end] : student.get_coverage(cfg)) {
+                    add(first.get_chunk_of_week());
+                    add(end.get_chunk_of_week());
+                }
+            }
+            for (unsigned day{}; day < 7; ++day) {
+                const Time lunch_from(Day(day), cfg.lunch_time_from_hour, cfg.lunch_time_from_minute),
+                           lunch_to(Day(day), cfg.lunch_time_to_hour, cfg.lunch_time_to_minute);
+                add(lunch_from.get_chunk_of_week() / cell * cell);
+                add((lunch_to.get_chunk_of_week() + cell - 1) / cell * cell);
+            }
+
+            while (!pending.empty()) {
+                const unsigned chunk = pending.back();
+                pending.pop_back();
+                for (const auto length : lengths) {
+                    add(chunk + length);
+                    if (chunk >= length)
+                        add(chunk - length);
+                }
+            }
+            return anchors;
+        }
+
+        // the students see the anchors of this plan's students at the granularity of "cfg"
+        void assign_anchors(const struct solve_config& cfg) {
+            std::shared_ptr<const WeekMask> anchors;
+            if (cfg.candidate_mode == CandidateMode::BOUNDARY) {
+                anchors = std::make_shared<const WeekMask>(find_anchors(cfg));
+                if constexpr (print_stats)
+                    fmt::println("candidates: {} anchors", anchors->count());
+            }
+            for (auto& student : students)
+                student.set_anchors(anchors);
+        }
+
+        bool schedule_model(const struct solve_config& cfg) {
+            assign_anchors(cfg);
+            feasibility = feasibility_report{};
+            if (cfg.precheck) {
+                precheck(cfg);
+                if (!feasibility.feasible && !cfg.allow_skip) {
+                    status = CpSolverStatus::INFEASIBLE;
+                    return false;
+                }
+            }
+
+            // "constraints_size" only grows, so every family gets what was added since the previous one
+            CpModelBuilder cp_model;
+            int counted_constraints{};
+            const auto count_constraints = [&](ConstraintFamily family) {
+                const int constraints = cp_model.Proto().constraints_size();
+                statistics[family] += constraints - counted_constraints;
+                counted_constraints = constraints;
+            };
+
+            std::optional<PhaseTimer> phase_timer;
+            phase_timer.emplace(statistics[Phase::VARIABLES]);
+
+            // the terms of each part of the objective
+            std::array<objective_terms, objective_names.size()> objective;
+
+            // the indices below live until the model is solved and are freed at once
+            std::pmr::monotonic_buffer_resource arena;
+
+            const bool intervals = cfg.model_encoding == ModelEncoding::INTERVAL;
+            for (auto& student : students) {
+                if (intervals)
+                    student.calculate_windows(cp_model, cfg);
+                else
+                    student.calculate_availabilities(cp_model, cfg);
+            }
+            const SlotIndex<wish> wishes(slots_per_week, &arena, [&](auto&& emit) {
+                for (const auto& student : students)
+                    for (const auto& [t, var, prio] : student.get_availabilities())
+                        emit(t.get_chunk_of_week(), wish{var, prio});
+            });
+
+            if (!hint.empty()) {
+                std::unordered_map<unsigned, Time> hint_per_id;
+                for (const auto& [id, start] : hint)
+                    hint_per_id.emplace(id, start);
+
+                unsigned hinted{};
+                for (auto& student : students) {
+                    const auto it = hint_per_id.find(student.get_id());
+                    if (it != hint_per_id.end() && student.add_hint(cp_model, it->second, cfg))
+                        ++hinted;
+                }
+
+                if constexpr (print_stats)
+                    fmt::println("hint: {} of {} students", hinted, students.size());
+            }
+            count_constraints(ConstraintFamily::AVAILABILITY);
+
+            if (cfg.break_symmetry)
+                constraint_symmetry(cp_model, cfg);
+            count_constraints(ConstraintFamily::SYMMETRY);
+
+            phase_timer.emplace(statistics[Phase::CONFLICTS]);
+            const SlotIndex<BoolVar> impact(cells_per_week(cfg), &arena, [&](auto&& emit) {
+                for (const auto& student : students)
+                    student.register_impact(emit, cfg);
+            });
+
+            if (intervals) {
+                std::vector<IntervalVar> lessons;
+                for (const auto& student : students)
+                    for (const auto& window : student.get_windows())
+                        lessons.push_back(window.interval);
+                cp_model.AddNoOverlap(lessons);
+            } else switch (cfg.conflict_encoding) {
+            case ConflictEncoding::PAIRWISE:
+                for (auto& student : students)
+                    student.register_conflicts(cp_model, wishes, cfg);
+                break;
+            case ConflictEncoding::AT_MOST_ONE:
+                constraint_conflicts_at_most_one(cp_model, impact);
+                break;
+            }
+            count_constraints(ConstraintFamily::CONFLICTS);
+
+            phase_timer.emplace(statistics[Phase::VARIABLES]);
+            if (cfg.minimize_wishes_prio) {
+                auto& wish_terms = AT(objective, unsigned(Objective::WISHES));
+                for (const auto& [var, prio] : wishes.get_values())
+                    wish_terms.add(var, prio);
+                for (const auto& student : students)
+                    for (const auto& window : student.get_windows())
+                        wish_terms.add(window.present, student.get_wish_prio(window.availability_index));
+            }
+            if (cfg.allow_skip) {
+                auto& skip_terms = AT(objective, unsigned(Objective::SKIPS));
+                for (auto& student : students)
+                    skip_terms.add(student.get_skip_var(), cfg.skip_prio);
+                if (feasibility.min_skipped)
+                    cp_model.AddGreaterOrEqual(LinearExpr::Sum(skip_terms.vars), feasibility.min_skipped);
+            }
+            count_constraints(ConstraintFamily::SKIP);
+
+            phase_timer.emplace(statistics[Phase::HOLES]);
+            if (cfg.minimize_holes) {
+                if (intervals)
+                    constraint_minimize_holes_intervals(cp_model, AT(objective, unsigned(Objective::HOLES)), cfg);
+                else
+                    constraint_minimize_holes(cp_model, impact, AT(objective, unsigned(Objective::HOLES)), cfg);
+            }
+            count_constraints(ConstraintFamily::HOLES);
+
+            // the neighbourhoods are searched on the weighted objective
+            const bool lexicographic = !cfg.objective_order.empty() && cfg.solve_mode != SolveMode::LNS;
+            const bool minimize = cfg.minimize_wishes_prio || cfg.minimize_holes || (lexicographic && cfg.allow_skip);
+            LinearExpr prio_sum;
+            for (const auto& terms : objective)
+                prio_sum += terms.sum();
+            if (minimize && !lexicographic)
+                cp_model.Minimize(prio_sum);
+            progress_objective = prio_sum;
+
+            if constexpr (print_stats)
+                fmt::println("model: {} variables, {} constraints ({})",
+                    cp_model.Proto().variables_size(),
+                    cp_model.Proto().constraints_size(),
+                    intervals ? "intervals" : fmt::format("{} conflicts", conflict_encoding_names.at(unsigned(cfg.conflict_encoding))));
+
+            statistics.models += 1;
+            statistics.variables += cp_model.Proto().variables_size();
+            statistics.model_bytes += cp_model.Proto().ByteSizeLong();
+
+            // the search runs on the solver's worker threads
+            phase_timer.emplace(statistics[Phase::SOLVE], CLOCK_PROCESS_CPUTIME_ID);
+            CpSolverResponse response;
+            if (lexicographic) {
+                response = solve_lexicographic(cp_model, objective, cfg);
+            } else if (cfg.solve_mode == SolveMode::LNS) {
+                response = solve_lns(cp_model, cfg);
+            } else {
+                response = solve_proto(cp_model.Build(), cfg, cfg.max_time_in_seconds);
+                status = response.status();
+                objective_value = response.objective_value();
+                best_objective_bound = response.best_objective_bound();
+            }
+            std::vector<CpSolverResponse> alternative_responses;
+            if (status == CpSolverStatus::OPTIMAL || status == CpSolverStatus::FEASIBLE)
+                alternative_responses = solve_alternatives(cp_model, response, cfg);
+            progress_objective.reset();
+            phase_timer.reset();
+
+            // a feasible solution is good enough if the time or gap limit stopped the search
+            if (status != CpSolverStatus::OPTIMAL && status != CpSolverStatus::FEASIBLE)
+                return false;
+
+            gap = minimize ? std::abs(objective_value - best_objective_bound) / std::max(1.0, std::abs(objective_value)) : 0.0;
+
+            if constexpr (build_mode::trace) {
+                for (unsigned day{}; day < 7; ++day) {
+                    const auto& [first, last, found] = AT(first_last_info_per_day, day);
+                    if (!found)
+                        continue;
+                    for (unsigned cell{first}; cell <= last; ++cell) {
+                        fmt::println("{}: used={}, usage_before={}, usage_after={}, hole={}",
+                            Time(cell * chunks_per_cell(cfg)),
+                            yon(SolutionIntegerValue(response, AT(used, cell))),
+                            yon(SolutionIntegerValue(response, AT(usage_before, cell))),
+                            yon(SolutionIntegerValue(response, AT(usage_after, cell))),
+                            ymn(SolutionIntegerValue(response, AT(hole, cell)), AT(hole, cell) == cp_model.FalseVar()));
+                    }
+                }
+            }
+
+            PhaseTimer extraction_timer(statistics[Phase::EXTRACTION]);
+            extract_schedule(response, cfg, result, skipped);
+            for (const auto* student : skipped)
+                fmt::println("skipping {} ({})", student->get_name(), student->get_id());
+
+            alternatives.clear();
+            for (const auto& alternative_response : alternative_responses) {
+                auto& alternative = alternatives.emplace_back(minimize ? double(SolutionIntegerValue(alternative_response, prio_sum)) : 0.0,
+                                                              alternative_response.status() == CpSolverStatus::OPTIMAL);
+                extract_schedule(alternative_response, cfg, alternative.result, alternative.skipped);
+            }
+
+            return true;
+        }
+
+        double elapsed() const { return std::chrono::duration<double>(std::chrono::steady_clock::now() - schedule_begin).count(); }
+
+        // passes "found" on if it is better than everything reported before
+        void report(incumbent&& found) {
+            if (reported_objective && found.objective_value >= *reported_objective)
+                return;
+            reported_objective = found.objective_value;
+            progress(found);
+        }
+
+        // a solution of the model being solved; its objective is re-evaluated as the weighted one
+        void report_incumbent(const CpSolverResponse& response, const struct solve_config& cfg) {
+            if (!progress)
+                return;
+            incumbent found{
+                .objective_value = progress_objective ? double(SolutionIntegerValue(response, *progress_objective)) : response.objective_value(),
+                .best_objective_bound = response.best_objective_bound(),
+                .time = elapsed(),
+                .result = {},
+                .skipped = {},
+            };
+            if (reported_objective && found.objective_value >= *reported_objective)
+                return;
+            extract_schedule(response, cfg, found.result, found.skipped);
+            report(std::move(found));
+        }
+
+        // the lessons and the skipped students of "response", in the order of the students
+        void extract_schedule(const CpSolverResponse& response, const struct solve_config& cfg,
+                              std::vector<schedule_result>& result, std::vector<const Student *>& skipped) const {
             skipped.clear();
             result.clear();
-            for (auto& student : students) {
+            for (const auto& student : students) {
                 if (cfg.allow_skip && student.is_skipped(response)) {
-                    fmt::println("skipping {} ({})", student.get_name(), student.get_id());
                     skipped.push_back(&student);
                     continue;
                 }
@@ -389,20 +1932,110 @@ class Plan {
                 const auto end = start + student.get_lesson_chunks();
                 result.emplace_back(start, end, &student);
             }
+        }
 
-            return true;
+        // up to "cfg.alternatives" further schedules from the same model, each the best one which places (or
+        // skips) at least "cfg.alternative_distance" students differently than every schedule before it. the
+        // cuts are added to the model, so it is built only once; every alternative gets the full time limit.
+        // the objective is the one of the model, after a lexicographic solve the last stage on top of the bounds of
+        // the ones before it, so the alternatives only differ from the best schedule in that stage.
+        std::vector<CpSolverResponse> solve_alternatives(CpModelBuilder& cp_model, const CpSolverResponse& best,
+                                                         const struct solve_config& cfg) {
+            std::vector<CpSolverResponse> found;
+            if (!cfg.alternatives || cfg.alternative_distance > students.size())
+                return found;
+            found.reserve(cfg.alternatives);
+
+            const CpSolverResponse* previous = &best;
+            for (unsigned number{1}; number <= cfg.alternatives; ++number) {
+                if (stop && *stop)
+                    break;
+
+                std::vector<BoolVar> same;
+                same.reserve(students.size());
+                for (const auto& student : students)
+                    same.push_back(student.add_same_placement(cp_model, *previous, cfg));
+                cp_model.AddLessOrEqual(LinearExpr::Sum(same), int64_t(students.size() - cfg.alternative_distance));
+
+                auto response = solve_proto(cp_model.Build(), cfg, cfg.max_time_in_seconds);
+                if (response.status() != CpSolverStatus::OPTIMAL && response.status() != CpSolverStatus::FEASIBLE)
+                    break;
+
+                if constexpr (print_stats)
+                    fmt::println("alternative {}: {} {}", number, CpSolverStatus_Name(response.status()), response.objective_value());
+                found.push_back(std::move(response));
+                previous = &found.back();
+            }
+            return found;
         }
 
-        std::vector<schedule_result> get_result() {
+        std::vector<schedule_result> get_result() const {
             return result;
         }
 
-        std::vector<const Student *> get_skipped() {
+        std::vector<const Student *> get_skipped() const {
             return skipped;
         }
 
+        // a further schedule from "solve_config::alternatives", worse than or as good as the returned one
+        struct alternative {
+            double objective_value;
+            bool optimal;
+            std::vector<schedule_result> result;
+            std::vector<const Student *> skipped;
+        };
+
+        const std::vector<alternative>& get_alternatives() const { return alternatives; }
+
+        CpSolverStatus get_status() const { return status; }
+        const std::string& get_status_name() const { return CpSolverStatus_Name(status); }
+        bool is_optimal() const { return status == CpSolverStatus::OPTIMAL; }
+        double get_objective_value() const { return objective_value; }
+        double get_best_objective_bound() const { return best_objective_bound; }
+        bool is_heuristic() const { return heuristic_solution; }
+        bool is_cached() const { return cached_solution; }
+        const char* get_engine_name() const { return cached_solution ? "cache" : heuristic_solution ? "heuristic" : "cp-sat"; }
+        // relative distance between the objective of the returned solution and the best proven bound
+        double get_gap() const { return gap; }
+
+        const solve_statistics& get_statistics() const { return statistics; }
+
+        // time spent reading the students, which happens before the plan exists
+        void set_input_time(const phase_time& input_time) {
+            statistics[Phase::INPUT] = input_time;
+        }
+
+        // result of the pre-check; only meaningful if "solve_config::precheck" was set
+        bool is_feasible() const { return feasibility.feasible; }
+        unsigned get_min_skipped() const { return feasibility.min_skipped; }
+        std::vector<const Student *> get_conflicting() const {
+            std::vector<const Student *> conflicting;
+            for (const auto index : feasibility.conflicting)
+                conflicting.push_back(&AT(students, index));
+            return conflicting;
+        }
+
     protected:
         std::vector<Student> students;
+        std::vector<schedule_hint> hint;
+        std::atomic<bool>* stop{nullptr};
+        // the flag of the last "schedule_async", which "stop" points to
+        std::shared_ptr<std::atomic<bool>> owned_stop;
         std::vector<schedule_result> result;
         std::vector<const Student *> skipped;
+        std::vector<alternative> alternatives;
+        progress_callback progress;
+        // the weighted objective of the model being solved, for reporting incumbents
+        std::optional<LinearExpr> progress_objective;
+        std::optional<double> reported_objective;
+        std::chrono::steady_clock::time_point schedule_begin{std::chrono::steady_clock::now()};
+        CpSolverStatus status{CpSolverStatus::UNKNOWN};
+        double objective_value{};
+        double best_objective_bound{};
+        double gap{};
+        bool heuristic_solution{false};
+        bool cached_solution{false};
+        ResultCache* cache{nullptr};
+        feasibility_report feasibility;
+        solve_statistics statistics;
 };
@@ -0,0 +1,183 @@
+#pragma once
+#include <unistd.h>
+
+#include <bit>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <fmt/format.h>
+
+// FNV-1a over fixed width little endian values, so that the same input gives the same hash on every platform
+class CanonicalHash {
+    public:
+        CanonicalHash& add(uint64_t value) {
+            for (unsigned byte{}; byte < 8; ++byte) {
+                state ^= (value >> (8 * byte)) & 0xff;
+                state *= prime;
+            }
+            return *this;
+        }
+
+        CanonicalHash& add(double value) { return add(std::bit_cast<uint64_t>(value)); }
+
+        CanonicalHash& add(const std::string& value) {
+            add(uint64_t(value.size()));
+            for (const unsigned char c : value) {
+                state ^= c;
+                state *= prime;
+            }
+            return *this;
+        }
+
+        uint64_t get() const { return state; }
+
+    protected:
+        static constexpr uint64_t prime = 0x100000001b3;
+        uint64_t state{0xcbf29ce484222325};
+};
+
+// an optimal schedule, by the index of the student in the input
+struct cached_result {
+    double objective_value{};
+    double best_objective_bound{};
+    std::vector<std::pair<size_t, unsigned>> lessons; // student, chunk of the week the lesson starts at
+    std::vector<size_t> skipped;
+};
+
+// results by input hash, the most recently used "capacity" ones in memory and, with a directory, all of them on
+// disk as one file each. safe to use from several threads.
+class ResultCache {
+    public:
+        static constexpr size_t default_capacity = 256;
+
+        explicit ResultCache(size_t capacity = default_capacity, std::optional<std::string> directory = std::nullopt) :
+            capacity{std::max<size_t>(1, capacity)}, directory{std::move(directory)} {
+            if (this->directory)
+                std::filesystem::create_directories(*this->directory);
+        }
+
+        ResultCache(const ResultCache&) = delete;
+        ResultCache& operator=(const ResultCache&) = delete;
+
+        std::optional<cached_result> find(uint64_t key) {
+            std::lock_guard lock(mutex);
+            if (const auto it = index.find(key); it != index.end()) {
+                entries.splice(entries.begin(), entries, it->second);
+                ++hits;
+                return it->second->second;
+            }
+            if (auto result = load(key)) {
+                remember(key, *result);
+                ++hits;
+                return result;
+            }
+            ++misses;
+            return std::nullopt;
+        }
+
+        void insert(uint64_t key, const cached_result& result) {
+            std::lock_guard lock(mutex);
+            remember(key, result);
+            store(key, result);
+        }
+
+        uint64_t get_hits() const { std::lock_guard lock(mutex); return hits; }
+        uint64_t get_misses() const { std::lock_guard lock(mutex); return misses; }
+        size_t get_size() const { std::lock_guard lock(mutex); return entries.size(); }
+
+    protected:
+        static constexpr const char* file_header = "student-planner-cache 2";
+        // the last line, so that a truncated file is not taken for a complete result
+        static constexpr const char* file_trailer = "end";
+
+        void remember(uint64_t key, const cached_result& result) {
+            if (const auto it = index.find(key); it != index.end()) {
+                it->second->second = result;
+                entries.splice(entries.begin(), entries, it->second);
+                return;
+            }
+            entries.emplace_front(key, result);
+            index.emplace(key, entries.begin());
+            if (entries.size() > capacity) {
+                index.erase(entries.back().first);
+                entries.pop_back();
+            }
+        }
+
+        std::filesystem::path path(uint64_t key) const { return std::filesystem::path(*directory) / fmt::format("{:016x}", key); }
+
+        // written to a temporary file first, so that a concurrent reader never sees half a result. the name of the
+        // temporary file is unique to the process and the thread, since processes may share the directory.
+        void store(uint64_t key, const cached_result& result) const {
+            if (!directory)
+                return;
+            const auto target = path(key);
+            auto temporary = target;
+            temporary += fmt::format(".{}.{:x}.tmp", getpid(), std::hash<std::thread::id>{}(std::this_thread::get_id()));
+            std::ofstream file(temporary);
+            file << file_header << '\n';
+            file << fmt::format("objective {} {}\n", result.objective_value, result.best_objective_bound);
+            for (const auto& [student, start] : result.lessons)
+                file << fmt::format("lesson {} {}\n", student, start);
+            for (const auto student : result.skipped)
+                file << fmt::format("skip {}\n", student);
+            file << file_trailer << '\n';
+            // closing flushes, which may fail as well
+            file.close();
+
+            std::error_code error;
+            if (!file) {
+                std::filesystem::remove(temporary, error);
+                return;
+            }
+            std::filesystem::rename(temporary, target, error);
+            if (error)
+                std::filesystem::remove(temporary, error);
+        }
+
+        // a file which cannot be read counts as a miss. whether the result fits the students is up to the caller.
+        std::optional<cached_result> load(uint64_t key) const {
+            if (!directory)
+                return std::nullopt;
+            std::ifstream file(path(key));
+            std::string line;
+            if (!std::getline(file, line) || line != file_header)
+                return std::nullopt;
+
+            cached_result result;
+            for (std::string kind; file >> kind;) {
+                if (kind == file_trailer)
+                    return result;
+                if (kind == "objective") {
+                    file >> result.objective_value >> result.best_objective_bound;
+                } else if (kind == "lesson") {
+                    auto& [student, start] = result.lessons.emplace_back();
+                    file >> student >> start;
+                } else if (kind == "skip") {
+                    file >> result.skipped.emplace_back();
+                } else {
+                    return std::nullopt;
+                }
+                if (!file)
+                    return std::nullopt;
+            }
+            // no trailer: truncated
+            return std::nullopt;
+        }
+
+        const size_t capacity;
+        const std::optional<std::string> directory;
+        mutable std::mutex mutex;
+        std::list<std::pair<uint64_t, cached_result>> entries; // most recently used first
+        std::unordered_map<uint64_t, std::list<std::pair<uint64_t, cached_result>>::iterator> index;
+        uint64_t hits{};
+        uint64_t misses{};
+};
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstdint>
+#include <memory_resource>
+#include <numeric>
+#include <span>
+#include <vector>
+#include "config.hpp"
+
+// values grouped by row (a chunk or a cell of the week) in one contiguous array, compressed sparse row style.
+// "generate" is called twice with a callback taking (row, value): once to count the values per row and once
+// to store them, so it has to produce the same values both times. within a row, the values keep the order in
+// which they were generated. all storage comes from "resource", typically an arena which lives as long as
+// the model.
+template <typename T>
+class SlotIndex {
+    public:
+        template <typename Generate>
+        SlotIndex(size_t rows, std::pmr::memory_resource* resource, Generate&& generate) :
+            offsets(rows + 1, 0, resource),
+            values(resource) {
+            generate([this](size_t row, const T&) { ++AT(offsets, row + 1); });
+            std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+            values.resize(offsets.back());
+            std::pmr::vector<uint32_t> next(offsets.begin(), offsets.end() - 1, resource);
+            generate([&](size_t row, const T& value) { AT(values, AT(next, row)++) = value; });
+        }
+
+        size_t size() const { return offsets.size() - 1; }
+        size_t value_count() const { return values.size(); }
+
+        std::span<const T> operator[](size_t row) const {
+            return std::span<const T>(values.data() + offsets[row], offsets[row + 1] - offsets[row]);
+        }
+
+        std::span<const T> at(size_t row) const {
+            return std::span<const T>(values.data() + offsets.at(row), offsets.at(row + 1) - offsets.at(row));
+        }
+
+        const std::pmr::vector<T>& get_values() const { return values; }
+
+    protected:
+        std::pmr::vector<uint32_t> offsets; // row "r" is [offsets[r], offsets[r + 1])
+        std::pmr::vector<T> values;
+};
@@ -0,0 +1,178 @@
+#pragma once
+#include <time.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include "config.hpp"
+
+enum class Phase {
+    TOTAL,       // all of "Plan::schedule"
+    INPUT,       // reading the students, measured by the caller
+    PRECHECK,
+    VARIABLES,   // availability and skip variables, hints
+    CONFLICTS,
+    HOLES,
+    SOLVE,       // CPU time of the whole process, see "PhaseTimer"
+    EXTRACTION,
+};
+
+constexpr std::array phase_names = {
+    "total",
+    "input",
+    "precheck",
+    "variables",
+    "conflicts",
+    "holes",
+    "solve",
+    "extraction",
+};
+
+// the constraints of the model, grouped by what adds them
+enum class ConstraintFamily {
+    AVAILABILITY,  // one start per student (or skip)
+    SYMMETRY,      // order of interchangeable students
+    CONFLICTS,
+    SKIP,          // lower bound on the skipped students from the pre-check
+    HOLES,
+};
+
+constexpr std::array constraint_family_names = {
+    "availability",
+    "symmetry",
+    "conflicts",
+    "skip",
+    "holes",
+};
+
+struct phase_time {
+    double wall{};
+    double cpu{};
+
+    phase_time& operator+=(const phase_time& other) {
+        wall += other.wall;
+        cpu += other.cpu;
+        return *this;
+    }
+};
+
+// wall and CPU time from construction until "stop" (or destruction), added to "target". the CPU time is the one
+// of the calling thread, or of the whole process for phases which run on other threads (the solver's workers).
+// the process CPU time includes everything else the process runs meanwhile, e.g. the other jobs of
+// "solve_batch" or of a daemon with more than one parallel job.
+class PhaseTimer {
+    public:
+        explicit PhaseTimer(phase_time& target, clockid_t cpu_clock = CLOCK_THREAD_CPUTIME_ID) :
+            target{&target}, cpu_clock{cpu_clock}, wall_begin{std::chrono::steady_clock::now()}, cpu_begin{cpu_now(cpu_clock)} {}
+
+        PhaseTimer(const PhaseTimer&) = delete;
+        PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+        ~PhaseTimer() { stop(); }
+
+        void stop() {
+            if (!target)
+                return;
+            target->wall += std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_begin).count();
+            target->cpu += cpu_now(cpu_clock) - cpu_begin;
+            target = nullptr;
+        }
+
+        static double cpu_now(clockid_t cpu_clock) {
+            timespec t;
+            clock_gettime(cpu_clock, &t);
+            return t.tv_sec + t.tv_nsec * 1e-9;
+        }
+
+    protected:
+        phase_time* target;
+        const clockid_t cpu_clock;
+        const std::chrono::steady_clock::time_point wall_begin;
+        const double cpu_begin;
+};
+
+// one stage of a lexicographic solve. "wall" is the time to the proof of optimality if "optimal" is set, "cpu" is
+// process-wide like the one of "Phase::SOLVE".
+struct stage_statistics {
+    Objective objective{};
+    bool optimal{};
+    double objective_value{};
+    double best_objective_bound{};
+    phase_time time;
+
+    stage_statistics& operator+=(const stage_statistics& other) {
+        optimal &= other.optimal;
+        objective_value += other.objective_value;
+        best_objective_bound += other.best_objective_bound;
+        time += other.time;
+        return *this;
+    }
+};
+
+// objective of the best schedule so far, "time" seconds after the solve of its model began
+struct trace_point {
+    double time;
+    double objective;
+};
+
+struct solve_statistics {
+    std::array<phase_time, phase_names.size()> phases{};
+
+    // model size, summed over all solved models
+    unsigned models{};
+    int64_t variables{};
+    int64_t model_bytes{}; // serialized size, including the variable names
+    std::array<int64_t, constraint_family_names.size()> constraints{};
+
+    // solver counters
+    int64_t conflicts{};
+    int64_t branches{};
+    double best_objective_bound{};
+    double gap{};
+
+    // groups of interchangeable students, and the students in them
+    unsigned symmetry_classes{};
+    unsigned symmetric_students{};
+
+    // lookups in the result cache; a hit skips everything else
+    unsigned cache_hits{};
+    unsigned cache_misses{};
+
+    // lexicographic solves only
+    std::vector<stage_statistics> stages;
+
+    // large neighbourhood search only, the points of all models one after the other
+    std::vector<trace_point> trace;
+
+    phase_time& operator[](Phase phase) { return AT(phases, unsigned(phase)); }
+    const phase_time& operator[](Phase phase) const { return AT(phases, unsigned(phase)); }
+    int64_t& operator[](ConstraintFamily family) { return AT(constraints, unsigned(family)); }
+    int64_t operator[](ConstraintFamily family) const { return AT(constraints, unsigned(family)); }
+
+    // adds the sizes, counters and times of another model; the bound and the gap are left to the caller
+    solve_statistics& operator+=(const solve_statistics& other) {
+        for (size_t i{}; i < phases.size(); ++i)
+            phases[i] += other.phases[i];
+        models += other.models;
+        variables += other.variables;
+        model_bytes += other.model_bytes;
+        for (size_t i{}; i < constraints.size(); ++i)
+            constraints[i] += other.constraints[i];
+        conflicts += other.conflicts;
+        branches += other.branches;
+        symmetry_classes += other.symmetry_classes;
+        symmetric_students += other.symmetric_students;
+        cache_hits += other.cache_hits;
+        cache_misses += other.cache_misses;
+        // the components all solve the same stages
+        if (stages.empty())
+            stages = other.stages;
+        else
+            for (size_t i{}; i < std::min(stages.size(), other.stages.size()); ++i)
+                stages[i] += other.stages[i];
+        trace.insert(trace.end(), other.trace.begin(), other.trace.end());
+        return *this;
+    }
+};
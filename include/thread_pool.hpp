@@ -0,0 +1,73 @@
+#pragma once
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// fixed number of worker threads processing tasks in submission order
+class ThreadPool {
+    public:
+        explicit ThreadPool(unsigned thread_count = std::thread::hardware_concurrency()) {
+            thread_count = std::max(1u, thread_count);
+            threads.reserve(thread_count);
+            for (unsigned i{}; i < thread_count; ++i)
+                threads.emplace_back([this] { run(); });
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        // finishes all queued tasks before joining the threads
+        ~ThreadPool() {
+            {
+                std::lock_guard lock(mutex);
+                stopping = true;
+            }
+            condition.notify_all();
+            for (auto& thread : threads)
+                thread.join();
+        }
+
+        template <typename F>
+        std::future<std::invoke_result_t<F>> submit(F&& f) {
+            using R = std::invoke_result_t<F>;
+            auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(f));
+            auto future = task->get_future();
+            {
+                std::lock_guard lock(mutex);
+                tasks.emplace([task] { (*task)(); });
+            }
+            condition.notify_one();
+            return future;
+        }
+
+        unsigned size() const { return threads.size(); }
+
+    protected:
+        void run() {
+            for (;;) {
+                std::function<void()> task;
+                {
+                    std::unique_lock lock(mutex);
+                    condition.wait(lock, [this] { return stopping || !tasks.empty(); });
+                    if (tasks.empty())
+                        return;
+                    task = std::move(tasks.front());
+                    tasks.pop();
+                }
+                task();
+            }
+        }
+
+        std::vector<std::thread> threads;
+        std::queue<std::function<void()>> tasks;
+        std::mutex mutex;
+        std::condition_variable condition;
+        bool stopping{false};
+};
@@ -0,0 +1,147 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <cstdint>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+#include "config.hpp"
+#include "time.hpp"
+
+// one bit per chunk of the week. the storage is padded to whole 256 bit lanes so that the AVX2 kernels
+// never need a scalar tail; the padding bits are always zero. the kernels are chosen at compile time: AVX2 only
+// if the translation unit targets it (the Makefile does so for bench/week_mask only), scalar otherwise.
+class WeekMask {
+    public:
+        static constexpr size_t bits_per_word = 64;
+        static constexpr size_t words_per_lane = 4;
+        static constexpr size_t lane_count = (slots_per_week + bits_per_word * words_per_lane - 1) / (bits_per_word * words_per_lane);
+        static constexpr size_t word_count = lane_count * words_per_lane;
+
+        void set(unsigned chunk_of_week) {
+            AT(words, chunk_of_week / bits_per_word) |= uint64_t(1) << (chunk_of_week % bits_per_word);
+        }
+
+        bool test(unsigned chunk_of_week) const {
+            return AT(words, chunk_of_week / bits_per_word) >> (chunk_of_week % bits_per_word) & 1;
+        }
+
+        // sets [from, to)
+        void set_range(Time from, Time to) {
+            unsigned chunk = from.get_chunk_of_week();
+            const unsigned end = std::min<unsigned>(to.get_chunk_of_week(), slots_per_week);
+            while (chunk < end) {
+                const unsigned bit = chunk % bits_per_word;
+                const unsigned n = std::min<unsigned>(bits_per_word - bit, end - chunk);
+                const uint64_t bits = n == bits_per_word ? ~uint64_t(0) : ((uint64_t(1) << n) - 1) << bit;
+                AT(words, chunk / bits_per_word) |= bits;
+                chunk += n;
+            }
+        }
+
+        WeekMask& operator|=(const WeekMask& other) {
+#ifdef __AVX2__
+            for (size_t lane{}; lane < lane_count; ++lane)
+                store(lane, _mm256_or_si256(load(lane), other.load(lane)));
+#else
+            for (size_t i{}; i < word_count; ++i)
+                words[i] |= other.words[i];
+#endif
+            return *this;
+        }
+
+        WeekMask& operator&=(const WeekMask& other) {
+#ifdef __AVX2__
+            for (size_t lane{}; lane < lane_count; ++lane)
+                store(lane, _mm256_and_si256(load(lane), other.load(lane)));
+#else
+            for (size_t i{}; i < word_count; ++i)
+                words[i] &= other.words[i];
+#endif
+            return *this;
+        }
+
+        friend WeekMask operator|(const WeekMask& a, const WeekMask& b) { WeekMask r = a; return r |= b; }
+        friend WeekMask operator&(const WeekMask& a, const WeekMask& b) { WeekMask r = a; return r &= b; }
+        friend bool operator==(const WeekMask&, const WeekMask&) = default;
+
+        bool intersects(const WeekMask& other) const {
+#ifdef __AVX2__
+            for (size_t lane{}; lane < lane_count; ++lane)
+                if (!_mm256_testz_si256(load(lane), other.load(lane)))
+                    return true;
+            return false;
+#else
+            for (size_t i{}; i < word_count; ++i)
+                if (words[i] & other.words[i])
+                    return true;
+            return false;
+#endif
+        }
+
+        bool none() const {
+#ifdef __AVX2__
+            for (size_t lane{}; lane < lane_count; ++lane)
+                if (!_mm256_testz_si256(load(lane), load(lane)))
+                    return false;
+            return true;
+#else
+            for (const auto word : words)
+                if (word)
+                    return false;
+            return true;
+#endif
+        }
+
+        unsigned count() const {
+#ifdef __AVX2__
+            // nibble lookup popcount (Mula et al.), summed per 64 bit word with _mm256_sad_epu8
+            const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                                    0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+            const __m256i low_mask = _mm256_set1_epi8(0x0f);
+            __m256i total = _mm256_setzero_si256();
+            for (size_t lane{}; lane < lane_count; ++lane) {
+                const __m256i v = load(lane);
+                const __m256i lo = _mm256_shuffle_epi8(lookup, _mm256_and_si256(v, low_mask));
+                const __m256i hi = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask));
+                total = _mm256_add_epi64(total, _mm256_sad_epu8(_mm256_add_epi8(lo, hi), _mm256_setzero_si256()));
+            }
+            return _mm256_extract_epi64(total, 0) + _mm256_extract_epi64(total, 1) +
+                   _mm256_extract_epi64(total, 2) + _mm256_extract_epi64(total, 3);
+#else
+            unsigned n{};
+            for (const auto word : words)
+                n += std::popcount(word);
+            return n;
+#endif
+        }
+
+        // every day which has at least one chunk set becomes completely set
+        WeekMask expand_to_days() const {
+            constexpr unsigned chunks_per_day = 24 * 60 / MIN_ALIGNMENT;
+            WeekMask days;
+            for (unsigned day{}; day < 7; ++day) {
+                WeekMask day_mask;
+                day_mask.set_range(Time(day * chunks_per_day), Time((day + 1) * chunks_per_day));
+                if (intersects(day_mask))
+                    days |= day_mask;
+            }
+            return days;
+        }
+
+        // calls f(chunk_of_week) for every set chunk in ascending order
+        template <typename F>
+        void for_each(F&& f) const {
+            for (size_t i{}; i < word_count; ++i)
+                for (uint64_t word = words[i]; word; word &= word - 1)
+                    f(unsigned(i * bits_per_word + std::countr_zero(word)));
+        }
+
+    protected:
+#ifdef __AVX2__
+        __m256i load(size_t lane) const { return _mm256_load_si256(reinterpret_cast<const __m256i*>(&words[lane * words_per_lane])); }
+        void store(size_t lane, __m256i v) { _mm256_store_si256(reinterpret_cast<__m256i*>(&words[lane * words_per_lane]), v); }
+#endif
+
+        alignas(32) std::array<uint64_t, word_count> words{};
+};
@@ -0,0 +1,124 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <string>
+#include <utility>
+#include <vector>
+#include <fmt/format.h>
+#include "config.hpp"
+#include "plan.hpp"
+#include "time.hpp"
+
+// splitmix64. the distributions of <random> are implementation-defined, so a seed would not give the same workload
+// with every standard library; this generator and the helpers below are fully specified.
+class WorkloadRandom {
+    public:
+        explicit WorkloadRandom(uint64_t seed) : state{seed} {}
+
+        uint64_t next() {
+            uint64_t z = (state += 0x9e3779b97f4a7c15);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+            return z ^ (z >> 31);
+        }
+
+        // [0, n); the modulo bias is negligible for the small ranges used here
+        unsigned below(unsigned n) { return next() % n; }
+
+        // [from, to]
+        unsigned between(unsigned from, unsigned to) { return from + below(to - from + 1); }
+
+        // [0, 1)
+        double uniform() { return (next() >> 11) * 0x1.0p-53; }
+
+        bool chance(double p) { return uniform() < p; }
+
+    protected:
+        uint64_t state;
+};
+
+struct workload_config {
+    unsigned student_count{50};
+    unsigned min_windows{1};
+    unsigned max_windows{3};
+    // lesson durations in minutes with their relative frequencies
+    std::vector<std::pair<unsigned, unsigned>> duration_mix{{30, 3}, {45, 2}, {60, 1}};
+    // probability that a window lies on one of the student's two preferred days instead of any weekday
+    double day_clustering{0.5};
+    // 0: the windows are spread over the whole teaching day, 1: they are squeezed into the afternoon band
+    double overlap_density{0.5};
+    unsigned window_min_minutes{60};
+    unsigned window_max_minutes{240};
+    uint64_t seed{1};
+};
+
+// the teaching day, and the afternoon band in which most wishes cluster
+constexpr unsigned workload_day_from = 8 * 60;
+constexpr unsigned workload_day_to = 20 * 60;
+constexpr unsigned workload_band_from = 14 * 60;
+constexpr unsigned workload_band_to = 18 * 60;
+// windows start and end on quarter hours, like the ones entered by hand, as far as the chunks allow
+constexpr unsigned workload_grid = std::lcm(15u, MIN_ALIGNMENT);
+
+struct workload_student {
+    unsigned id;
+    std::string name;
+    unsigned lesson_duration;  // minutes
+    std::vector<std::pair<Time, Time>> availabilities;
+};
+
+inline std::vector<workload_student> generate_workload(const workload_config& cfg) {
+    WorkloadRandom random(cfg.seed);
+
+    unsigned duration_weight_sum{};
+    for (const auto& [duration, weight] : cfg.duration_mix)
+        duration_weight_sum += weight;
+
+    const auto lerp = [](unsigned a, unsigned b, double t) { return unsigned(a + (double(b) - a) * t); };
+    const unsigned band_from = lerp(workload_day_from, workload_band_from, cfg.overlap_density) / workload_grid * workload_grid;
+    const unsigned band_to = lerp(workload_day_to, workload_band_to, cfg.overlap_density) / workload_grid * workload_grid;
+
+    std::vector<workload_student> students;
+    students.reserve(cfg.student_count);
+    for (unsigned index{}; index < cfg.student_count; ++index) {
+        auto& student = students.emplace_back(index + 1, fmt::format("student {}", index + 1), cfg.duration_mix.front().first);
+
+        for (unsigned pick = random.below(std::max(1u, duration_weight_sum)); const auto& [duration, weight] : cfg.duration_mix) {
+            if (pick < weight) {
+                student.lesson_duration = duration;
+                break;
+            }
+            pick -= weight;
+        }
+
+        const unsigned preferred_days[2] = {random.below(5), random.below(5)};
+        const unsigned windows = random.between(cfg.min_windows, std::max(cfg.min_windows, cfg.max_windows));
+        for (unsigned window{}; window < windows; ++window) {
+            const auto day = Day(random.chance(cfg.day_clustering) ? preferred_days[random.below(2)] : random.below(5));
+
+            // at least one lesson fits, and the window never leaves the band
+            const unsigned band_length = band_to - band_from;
+            const unsigned min_length = std::min(band_length, std::max(cfg.window_min_minutes, student.lesson_duration));
+            const unsigned max_length = std::min(band_length, std::max(min_length, cfg.window_max_minutes));
+            const unsigned min_units = (min_length + workload_grid - 1) / workload_grid;
+            const unsigned length = random.between(min_units, std::max(min_units, max_length / workload_grid)) * workload_grid;
+            const unsigned from = band_from + random.between(0, (band_length - length) / workload_grid) * workload_grid;
+            const unsigned to = from + length;
+            student.availabilities.emplace_back(Time(day, from / 60, from % 60), Time(day, to / 60, to % 60));
+        }
+    }
+    return students;
+}
+
+// in input order, so the student priorities are the same as when reading the workload from JSON
+inline std::vector<Student> to_students(const std::vector<workload_student>& workload) {
+    std::vector<Student> students;
+    students.reserve(workload.size());
+    for (const auto& generated : workload) {
+        auto& student = students.emplace_back(generated.id, generated.name, generated.lesson_duration, students.size() + 1);
+        for (const auto& [from, to] : generated.availabilities)
+            student.add_availability(from, to);
+    }
+    return students;
+}
@@ -1,8 +1,19 @@
 #include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <sys/stat.h>
 #include <unistd.h>
 
+#include <atomic>
+#include <chrono>
 #include <fstream>
+#include <iostream>
+#include <list>
+#include <mutex>
+#include <set>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <array>
 #include <vector>
 #include <algorithm>
@@ -12,10 +23,13 @@
 #include <fmt/format.h>
 #include "time.hpp"
 #include "plan.hpp"
+#include "http_client.hpp"
+#include "thread_pool.hpp"
 
 std::vector<Student> read_student_config(const nlohmann::json& config) {
     // implementation note: the element accesses below will fail if the data is not convertible with the "get" function
     std::vector<Student> students;
+    students.reserve(config.size());
     for (const auto& student_config : config) {
         const auto id = student_config.find("id").value().get<unsigned>();
         const auto name = student_config.find("name").value().get<std::string>();
@@ -30,12 +44,27 @@ std::vector<Student> read_student_config(const nlohmann::json& config) {
             const auto to_minute   = availability.find("to_minute").value().get<unsigned>();
             student.add_availability(Time(day, from_hour, from_minute), Time(day, to_hour, to_minute));
         }
-        students.push_back(student);
+        students.push_back(std::move(student));
     }
     return students;
 }
 
-void print_schedult_result(const std::vector<Plan::schedule_result>& result,
+// accepts either a full result object as written by "-o" or just its "schedule" array
+std::vector<Plan::schedule_hint> read_schedule_hint(const nlohmann::json& previous) {
+    const auto& schedule = previous.is_object() ? previous.find("schedule").value() : previous;
+    std::vector<Plan::schedule_hint> hint;
+    for (const auto& entry : schedule) {
+        const auto id          = entry.find("id").value().get<unsigned>();
+        const auto day         = parse_day(entry.find("day").value().get<std::string>());
+        const auto from_hour   = entry.find("from_hour").value().get<unsigned>();
+        const auto from_minute = entry.find("from_minute").value().get<unsigned>();
+        hint.emplace_back(id, Time(day, from_hour, from_minute));
+    }
+    return hint;
+}
+
+void print_schedult_result(const Plan& plan,
+                           const std::vector<Plan::schedule_result>& result,
                            const std::vector<const Student *>& skipped) {
     unsigned prio_sum{};
     for (const auto& student_result : result) {
@@ -52,21 +81,56 @@ void print_schedult_result(const std::vector<Plan::schedule_result>& result,
         fmt::println("SKIPPED: {} ({})", student_skipped->get_name(), student_skipped->get_id());
     }
     fmt::println("priority sum: {}", prio_sum);
+    fmt::println("status: {} (gap {:.2f}%, {})", plan.get_status_name(), 100 * plan.get_gap(), plan.get_engine_name());
+}
+
+void print_schedult_alternatives(const Plan& plan) {
+    unsigned number{};
+    for (const auto& alternative : plan.get_alternatives()) {
+        fmt::println("\nalternative {}: objective {}{}", ++number, alternative.objective_value, alternative.optimal ? " (optimal)" : "");
+        for (const auto& student_result : alternative.result)
+            fmt::println("{} - {:t}: {}", student_result.start, student_result.end, student_result.student->get_name());
+        for (auto student_skipped : alternative.skipped)
+            fmt::println("SKIPPED: {} ({})", student_skipped->get_name(), student_skipped->get_id());
+    }
 }
 
-void signal_handler(int signal) {
-    if (signal == SIGALRM)
-        fmt::println("timeout reached");
+static std::atomic<bool> stop_requested{false};
 
-    exit(EXIT_FAILURE);
+// the first interrupt stops the solver, which then returns the best schedule found so far; the second one exits
+void signal_handler(int) {
+    if (stop_requested)
+        _exit(EXIT_FAILURE);
+    stop_requested = true;
 }
 
 struct arguments {
     const char *json_input;
     const char *json_output;
+    const char *json_hint;
+    bool repair_hint;
+    bool decompose;
+    unsigned num_workers;
+    bool precheck;
+    bool break_symmetry;
+    SolveMode solve_mode;
+    std::vector<Objective> objective_order;
+    unsigned time_granularity;
+    unsigned coarse_granularity;
     unsigned range_attempts;
     unsigned range_increment;
-    unsigned timeout;
+    CandidateMode candidate_mode;
+    double time_limit;
+    double relative_gap_limit;
+    ConflictEncoding conflict_encoding;
+    HoleEncoding hole_encoding;
+    ModelEncoding model_encoding;
+    unsigned alternatives;
+    unsigned alternative_distance;
+    const char *daemon_source;
+    double poll_interval;
+    unsigned daemon_jobs;
+    const char *cache_dir;
 };
 
 class argument_exception : std::exception {
@@ -81,22 +145,65 @@ arguments parse_arguments(int argc, char* const* argv) {
     arguments ret{
         .json_input = nullptr,
         .json_output = nullptr,
+        .json_hint = nullptr,
+        .repair_hint = false,
+        .decompose = true,
+        .num_workers = 0,
+        .precheck = true,
+        .break_symmetry = true,
+        .solve_mode = SolveMode::EXACT,
+        .objective_order = {},
+        .time_granularity = default_time_granularity,
+        .coarse_granularity = 0,
         .range_attempts = default_range_attempts,
         .range_increment = default_range_increment,
-        .timeout = 0
+        .candidate_mode = CandidateMode::UNIFORM,
+        .time_limit = 0,
+        .relative_gap_limit = 0,
+        .conflict_encoding = ConflictEncoding::AT_MOST_ONE,
+        .hole_encoding = HoleEncoding::CHAIN,
+        .model_encoding = ModelEncoding::BOOLEAN,
+        .alternatives = 0,
+        .alternative_distance = 1,
+        .daemon_source = nullptr,
+        .poll_interval = 10,
+        .daemon_jobs = 1,
+        .cache_dir = nullptr,
     };
 
     int c;
     opterr = 0;
-    while ((c = getopt(argc, argv, "i:o:a:d:t:h")) != -1)
+    while ((c = getopt(argc, argv, "i:o:p:ra:d:A:t:g:c:e:b:Mj:NSm:L:G:F:K:H:C:D:P:J:h")) != -1)
         switch (c) {
             case 'h':
                 fmt::println("usage: {} "
                              "-i <input-json> "
                              "[-o <output-json>] "
+                             "[-p <previous-output-json> [-r]] "
                              "[-a <range-attempts>] "
                              "[-d <range-increments>] "
-                             "[-t <timeout>]", argv[0]);
+                             "[-A <uniform|boundary>] "
+                             "[-t <time-limit-seconds>] "
+                             "[-g <relative-gap-limit>] "
+                             "[-c <pairwise|at-most-one>] "
+                             "[-e <prefix|chain>] "
+                             "[-b <boolean|interval>] "
+                             "[-M] "
+                             "[-j <solver-workers>] "
+                             "[-N] "
+                             "[-S] "
+                             "[-m <exact|heuristic|heuristic-then-exact|lns>] "
+                             "[-L <objective>,... (skips, wishes, holes)] "
+                             "[-G <granularity-minutes>] "
+                             "[-F <coarse-granularity-minutes>] "
+                             "[-K <alternatives> [-H <min-differing-students>]] "
+                             "[-C <cache-dir>]\n"
+                             "daemon: {} "
+                             "-D <job-server-url|jobs-ndjson|-> "
+                             "[-P <poll-interval-seconds>] "
+                             "[-J <parallel-jobs>] "
+                             "[-o <results-ndjson>] "
+                             "[options above]", argv[0], argv[0]);
                 exit(EXIT_SUCCESS);
 
             case 'i':
@@ -107,6 +214,14 @@ arguments parse_arguments(int argc, char* const* argv) {
                 ret.json_output = optarg;
                 break;
 
+            case 'p':
+                ret.json_hint = optarg;
+                break;
+
+            case 'r':
+                ret.repair_hint = true;
+                break;
+
             case 'a':
                 ret.range_attempts = atoi(optarg);
                 break;
@@ -115,12 +230,120 @@ arguments parse_arguments(int argc, char* const* argv) {
                 ret.range_increment = atoi(optarg);
                 break;
 
+            case 'A':
+                try {
+                    ret.candidate_mode = parse_candidate_mode(optarg);
+                } catch (std::runtime_error& ex) {
+                    throw argument_exception(ex.what());
+                }
+                break;
+
             case 't':
-                ret.timeout = atoi(optarg);
+                ret.time_limit = atof(optarg);
+                break;
+
+            case 'g':
+                ret.relative_gap_limit = atof(optarg);
+                break;
+
+            case 'c':
+                try {
+                    ret.conflict_encoding = parse_conflict_encoding(optarg);
+                } catch (std::runtime_error& ex) {
+                    throw argument_exception(ex.what());
+                }
+                break;
+
+            case 'e':
+                try {
+                    ret.hole_encoding = parse_hole_encoding(optarg);
+                } catch (std::runtime_error& ex) {
+                    throw argument_exception(ex.what());
+                }
+                break;
+
+            case 'b':
+                try {
+                    ret.model_encoding = parse_model_encoding(optarg);
+                } catch (std::runtime_error& ex) {
+                    throw argument_exception(ex.what());
+                }
+                break;
+
+            case 'M':
+                ret.decompose = false;
+                break;
+
+            case 'j':
+                ret.num_workers = atoi(optarg);
+                break;
+
+            case 'N':
+                ret.precheck = false;
+                break;
+
+            case 'S':
+                ret.break_symmetry = false;
+                break;
+
+            case 'm':
+                try {
+                    ret.solve_mode = parse_solve_mode(optarg);
+                } catch (std::runtime_error& ex) {
+                    throw argument_exception(ex.what());
+                }
+                break;
+
+            case 'L':
+                try {
+                    ret.objective_order = parse_objective_order(optarg);
+                } catch (std::runtime_error& ex) {
+                    throw argument_exception(ex.what());
+                }
+                break;
+
+            case 'G':
+                try {
+                    ret.time_granularity = validate_time_granularity(atoi(optarg));
+                } catch (std::runtime_error& ex) {
+                    throw argument_exception(ex.what());
+                }
+                break;
+
+            case 'F':
+                ret.coarse_granularity = atoi(optarg);
+                break;
+
+            case 'K':
+                ret.alternatives = atoi(optarg);
+                break;
+
+            case 'H':
+                try {
+                    ret.alternative_distance = validate_alternative_distance(atoi(optarg));
+                } catch (std::runtime_error& ex) {
+                    throw argument_exception(ex.what());
+                }
+                break;
+
+            case 'C':
+                ret.cache_dir = optarg;
+                break;
+
+            case 'D':
+                ret.daemon_source = optarg;
+                break;
+
+            case 'P':
+                ret.poll_interval = atof(optarg);
+                break;
+
+            case 'J':
+                ret.daemon_jobs = std::max(1, atoi(optarg));
                 break;
 
             case '?':
-                if (optopt == 'i' || optopt == 'o' || optopt == 'a' || optopt == 'd')
+                if (optopt == 'i' || optopt == 'o' || optopt == 'p' || optopt == 'a' || optopt == 'd' || optopt == 'A' || optopt == 't' || optopt == 'g' || optopt == 'c' || optopt == 'e' || optopt == 'b' || optopt == 'j' || optopt == 'm' || optopt == 'L' || optopt == 'G' || optopt == 'F' || optopt == 'K' || optopt == 'H' || optopt == 'C' || optopt == 'D' || optopt == 'P' || optopt == 'J')
                     throw argument_exception(fmt::format("Option -{:c} requires an argument.", char(optopt)));
                 else if (isprint(optopt))
                     throw argument_exception(fmt::format("Unknown option `-{:c}'.", char(optopt)));
@@ -133,12 +356,70 @@ arguments parse_arguments(int argc, char* const* argv) {
     if (optind < argc)
         throw argument_exception(fmt::format("Unknown argument `{}'", argv[optind]));
 
+    // checked after all options, since it depends on "-G"
+    try {
+        validate_coarse_granularity(ret.coarse_granularity, ret.time_granularity);
+    } catch (std::runtime_error& ex) {
+        throw argument_exception(ex.what());
+    }
+
     return ret;
 }
 
-nlohmann::json export_schedult_result(const std::vector<Plan::schedule_result>& result,
-                                      const std::vector<const Student *>& skipped,
-                                      const arguments& args) {
+nlohmann::json export_objective_order(const std::vector<Objective>& objective_order) {
+    nlohmann::json order = nlohmann::json::array();
+    for (const auto objective : objective_order)
+        order.push_back(objective_names.at(unsigned(objective)));
+    return order;
+}
+
+nlohmann::json export_statistics(const solve_statistics& statistics) {
+    nlohmann::json phases = nlohmann::json::object();
+    for (size_t phase{}; phase < phase_names.size(); ++phase)
+        phases[phase_names[phase]] = {
+            {"wall", statistics.phases[phase].wall},
+            {"cpu", statistics.phases[phase].cpu},
+        };
+
+    nlohmann::json constraints = nlohmann::json::object();
+    for (size_t family{}; family < constraint_family_names.size(); ++family)
+        constraints[constraint_family_names[family]] = statistics.constraints[family];
+
+    nlohmann::json stages = nlohmann::json::array();
+    for (const auto& stage : statistics.stages)
+        stages.push_back({
+            {"objective", objective_names.at(unsigned(stage.objective))},
+            {"optimal", stage.optimal},
+            {"objective_value", stage.objective_value},
+            {"best_objective_bound", stage.best_objective_bound},
+            {"wall", stage.time.wall},
+            {"cpu", stage.time.cpu},
+        });
+
+    nlohmann::json trace = nlohmann::json::array();
+    for (const auto& [time, objective] : statistics.trace)
+        trace.push_back({time, objective});
+
+    return nlohmann::json::object({
+        {"phases", phases},
+        {"models", statistics.models},
+        {"variables", statistics.variables},
+        {"model_bytes", statistics.model_bytes},
+        {"constraints", constraints},
+        {"conflicts", statistics.conflicts},
+        {"branches", statistics.branches},
+        {"symmetry_classes", statistics.symmetry_classes},
+        {"symmetric_students", statistics.symmetric_students},
+        {"cache_hits", statistics.cache_hits},
+        {"cache_misses", statistics.cache_misses},
+        {"best_objective_bound", statistics.best_objective_bound},
+        {"gap", statistics.gap},
+        {"stages", stages},
+        {"trace", trace},
+    });
+}
+
+nlohmann::json export_schedule_array(const std::vector<Plan::schedule_result>& result) {
     nlohmann::json schedule_array = nlohmann::json::array();
     for (const auto& student_result : result) {
         schedule_array.emplace_back(nlohmann::json::object({
@@ -151,7 +432,10 @@ nlohmann::json export_schedult_result(const std::vector<Plan::schedule_result>&
             {"to_minute", student_result.end.get_minute()},
         }));
     }
+    return schedule_array;
+}
 
+nlohmann::json export_skipped_array(const std::vector<const Student *>& skipped) {
     nlohmann::json skipped_array = nlohmann::json::array();
     for (const auto& student_skipped : skipped) {
         skipped_array.emplace_back(nlohmann::json::object({
@@ -159,19 +443,323 @@ nlohmann::json export_schedult_result(const std::vector<Plan::schedule_result>&
             {"name", student_skipped->get_name()},
         }));
     }
+    return skipped_array;
+}
+
+nlohmann::json export_schedult_result(const Plan& plan,
+                                      const std::vector<Plan::schedule_result>& result,
+                                      const std::vector<const Student *>& skipped,
+                                      const arguments& args) {
+    nlohmann::json alternatives = nlohmann::json::array();
+    for (const auto& alternative : plan.get_alternatives())
+        alternatives.push_back({
+            {"objective", alternative.objective_value},
+            {"optimal", alternative.optimal},
+            {"schedule", export_schedule_array(alternative.result)},
+            {"skipped", export_skipped_array(alternative.skipped)},
+        });
 
     return nlohmann::json::object({
-        {"schedule", schedule_array},
-        {"skipped", skipped_array},
+        {"schedule", export_schedule_array(result)},
+        {"skipped", export_skipped_array(skipped)},
+        {"alternatives", alternatives},
+        {"status", plan.get_status_name()},
+        {"optimal", plan.is_optimal()},
+        {"gap", plan.get_gap()},
+        {"engine", plan.get_engine_name()},
         {"options", {
             {"range_attempts", args.range_attempts},
             {"range_increments", args.range_increment},
-        },
-        //{"statistics", {}} // TODO: add generation statistics
-        }
+            {"candidate_mode", candidate_mode_names.at(unsigned(args.candidate_mode))},
+            {"conflict_encoding", conflict_encoding_names.at(unsigned(args.conflict_encoding))},
+            {"hole_encoding", hole_encoding_names.at(unsigned(args.hole_encoding))},
+            {"model_encoding", model_encoding_names.at(unsigned(args.model_encoding))},
+            {"time_limit", args.time_limit},
+            {"relative_gap_limit", args.relative_gap_limit},
+            {"repair_hint", args.repair_hint},
+            {"decompose", args.decompose},
+            {"precheck", args.precheck},
+            {"break_symmetry", args.break_symmetry},
+            {"mode", solve_mode_names.at(unsigned(args.solve_mode))},
+            {"objective_order", export_objective_order(args.objective_order)},
+            {"time_granularity", args.time_granularity},
+            {"coarse_granularity", args.coarse_granularity},
+            {"alternatives", args.alternatives},
+            {"alternative_distance", args.alternative_distance},
+        }},
+        {"statistics", export_statistics(plan.get_statistics())},
     });
 }
 
+struct solve_config make_solve_config(const arguments& args) {
+    return {
+        .range_attempts = args.range_attempts,
+        .range_increment = args.range_increment,
+        .candidate_mode = args.candidate_mode,
+        .minimize_wishes_prio = true,
+        .minimize_holes = true,
+        .lunch_time_from_hour = 12,
+        .lunch_time_from_minute = 0,
+        .lunch_time_to_hour = 13,
+        .lunch_time_to_minute = 0,
+        .lunch_hole_neg_prio = 10,
+        .non_lunch_hole_prio = 150,
+        .allow_skip = false,
+        .skip_prio = 1000000,
+        .conflict_encoding = args.conflict_encoding,
+        .hole_encoding = args.hole_encoding,
+        .max_time_in_seconds = args.time_limit,
+        .relative_gap_limit = args.relative_gap_limit,
+        .repair_hint = args.repair_hint,
+        .decompose = args.decompose,
+        .num_workers = args.num_workers,
+        .precheck = args.precheck,
+        .break_symmetry = args.break_symmetry,
+        .solve_mode = args.solve_mode,
+        .objective_order = args.objective_order,
+        .time_granularity = args.time_granularity,
+        .coarse_granularity = args.coarse_granularity,
+        .model_encoding = args.model_encoding,
+        .alternatives = args.alternatives,
+        .alternative_distance = args.alternative_distance,
+    };
+}
+
+// state shared by the jobs running in the daemon
+struct daemon_state {
+    // jobs whose last schedule is kept; the least recently solved ones are forgotten first
+    static constexpr size_t max_previous_solutions = 1024;
+
+    std::mutex mutex;
+    // last schedule per job, used as hint when the next revision of the job comes in. most recently solved first.
+    std::list<std::pair<std::string, std::vector<Plan::schedule_hint>>> previous_solutions;
+    std::unordered_map<std::string, decltype(previous_solutions)::iterator> previous_solution_index;
+    // jobs which are queued or being solved, so that polling does not pick them up again
+    std::set<std::string> in_flight;
+    // optimal results of recent jobs, and of all jobs on disk with "-C"
+    std::optional<ResultCache> cache;
+
+    // with "mutex" held
+    const std::vector<Plan::schedule_hint>* find_previous_solution(const std::string& key) const {
+        const auto it = previous_solution_index.find(key);
+        return it != previous_solution_index.end() ? &it->second->second : nullptr;
+    }
+
+    // with "mutex" held
+    void remember_solution(const std::string& key, std::vector<Plan::schedule_hint>&& hint) {
+        if (const auto it = previous_solution_index.find(key); it != previous_solution_index.end()) {
+            previous_solutions.erase(it->second);
+            previous_solution_index.erase(it);
+        }
+        previous_solutions.emplace_front(key, std::move(hint));
+        previous_solution_index.emplace(key, previous_solutions.begin());
+        if (previous_solutions.size() > max_previous_solutions) {
+            previous_solution_index.erase(previous_solutions.back().first);
+            previous_solutions.pop_back();
+        }
+    }
+};
+
+// job ids are numbers for the job server, but anything goes in a job stream
+std::string job_key(const nlohmann::json& job_id) {
+    return job_id.is_string() ? job_id.get<std::string>() : job_id.dump();
+}
+
+// the job server is lax with types: numbers may come as strings and flags as numbers
+template <typename T>
+T job_value(const nlohmann::json& job, const char* name, T fallback) {
+    const auto value = job.find(name);
+    if (value == job.end() || value->is_null())
+        return fallback;
+    const double number = value->is_string() ? std::stod(value->get<std::string>()) :
+                          value->is_boolean() ? value->get<bool>() :
+                          value->get<double>();
+    if constexpr (std::is_same_v<T, bool>)
+        return number != 0;
+    else
+        return T(number);
+}
+
+// solves one job as sent by the job server and returns the result to post back. the job carries the availabilities
+// and optionally the objective settings; everything else comes from the command line.
+nlohmann::json solve_job(const nlohmann::json& job_id, const nlohmann::json& job, const arguments& args, daemon_state& state) {
+    arguments job_args = args;
+    job_args.range_attempts = job_value(job, "range_attempts", args.range_attempts);
+    job_args.range_increment = job_value(job, "range_increments", args.range_increment);
+    job_args.alternatives = job_value(job, "alternatives", args.alternatives);
+    job_args.alternative_distance = std::max(1u, job_value(job, "alternative_distance", args.alternative_distance));
+
+    auto cfg = make_solve_config(job_args);
+    cfg.minimize_wishes_prio = job_value(job, "minimize_wishes_prio", cfg.minimize_wishes_prio);
+    cfg.minimize_holes = job_value(job, "minimize_holes", cfg.minimize_holes);
+    cfg.lunch_time_from_hour = job_value(job, "lunch_time_from_hour", cfg.lunch_time_from_hour);
+    cfg.lunch_time_from_minute = job_value(job, "lunch_time_from_minute", cfg.lunch_time_from_minute);
+    cfg.lunch_time_to_hour = job_value(job, "lunch_time_to_hour", cfg.lunch_time_to_hour);
+    cfg.lunch_time_to_minute = job_value(job, "lunch_time_to_minute", cfg.lunch_time_to_minute);
+    cfg.lunch_hole_neg_prio = job_value(job, "lunch_hole_neg_prio", cfg.lunch_hole_neg_prio);
+    cfg.non_lunch_hole_prio = job_value(job, "non_lunch_hole_prio", cfg.non_lunch_hole_prio);
+    cfg.allow_skip = job_value(job, "allow_skip", cfg.allow_skip);
+    cfg.skip_prio = job_value(job, "skip_prio", cfg.skip_prio);
+    // concurrent jobs share the cores. the solve CPU time in the statistics is process-wide, so it includes them
+    if (!cfg.num_workers && args.daemon_jobs > 1)
+        cfg.num_workers = std::max(1u, std::thread::hardware_concurrency() / args.daemon_jobs);
+
+    const auto key = job_key(job_id);
+    const auto begin = std::chrono::steady_clock::now();
+    nlohmann::json result = nlohmann::json::object({{"options", nlohmann::json::object()}});
+    bool success{false};
+    try {
+        phase_time input_time;
+        std::vector<Student> students;
+        {
+            PhaseTimer timer(input_time);
+            students = read_student_config(job.at("student_availabilities"));
+        }
+        Plan plan(std::move(students));
+        plan.set_input_time(input_time);
+        {
+            std::lock_guard lock(state.mutex);
+            if (const auto previous = state.find_previous_solution(key))
+                plan.set_hint(std::vector(*previous));
+        }
+        plan.set_stop_flag(&stop_requested);
+        plan.set_cache(state.cache ? &*state.cache : nullptr);
+
+        success = plan.schedule(cfg);
+        if (success) {
+            const auto schedule = plan.get_result();
+            result = export_schedult_result(plan, schedule, plan.get_skipped(), job_args);
+
+            std::vector<Plan::schedule_hint> hint;
+            for (const auto& student_result : schedule)
+                hint.emplace_back(student_result.student->get_id(), student_result.start);
+            std::lock_guard lock(state.mutex);
+            state.remember_solution(key, std::move(hint));
+        } else {
+            fmt::println(stderr, "job {}: could not create plan", key);
+        }
+    } catch (std::exception& ex) {
+        fmt::println(stderr, "job {}: {}", key, ex.what());
+    }
+
+    result["options"]["job_id"] = job_id;
+    result["options"]["revision"] = job.value("revision", nlohmann::json());
+    result["options"]["success"] = success;
+    result["options"]["execution_time"] = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    return result;
+}
+
+// sleeps, but wakes up early on an interrupt
+void interruptible_sleep(double seconds) {
+    const auto until = std::chrono::steady_clock::now() + std::chrono::duration<double>(seconds);
+    while (!stop_requested && std::chrono::steady_clock::now() < until)
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+}
+
+// polls "<url>/jobs" and posts every result to "<url>/jobs/<job_id>", like student-planner-worker does
+void run_daemon_http(const arguments& args) {
+    const HttpClient client(args.daemon_source);
+    daemon_state state;
+    state.cache.emplace(ResultCache::default_capacity, args.cache_dir ? std::optional<std::string>(args.cache_dir) : std::nullopt);
+    ThreadPool pool(args.daemon_jobs);
+
+    while (!stop_requested) {
+        bool submitted{false};
+        try {
+            for (const auto& entry : nlohmann::json::parse(client.get("/jobs"))) {
+                const auto job_id = entry.at("job_id");
+                const auto key = job_key(job_id);
+                {
+                    std::lock_guard lock(state.mutex);
+                    if (!state.in_flight.insert(key).second)
+                        continue;
+                }
+                submitted = true;
+                pool.submit([&client, &args, &state, job_id, key] {
+                    const auto path = fmt::format("/jobs/{}", key);
+                    // on shutdown, queued jobs are left to the server for the next worker
+                    if (stop_requested) {
+                        std::lock_guard lock(state.mutex);
+                        state.in_flight.erase(key);
+                        return;
+                    }
+                    try {
+                        const auto job = nlohmann::json::parse(client.get(path));
+                        client.post(path, solve_job(job_id, job, args, state).dump());
+                    } catch (std::exception& ex) {
+                        fmt::println(stderr, "job {}: {}", key, ex.what());
+                    }
+                    std::lock_guard lock(state.mutex);
+                    state.in_flight.erase(key);
+                });
+            }
+        } catch (std::exception& ex) {
+            fmt::println(stderr, "polling {} failed: {}", args.daemon_source, ex.what());
+        }
+
+        // if there was something new, go right to the next round
+        if (!submitted)
+            interruptible_sleep(args.poll_interval);
+    }
+}
+
+// reads one job per line from stdin ("-") or a file and writes one result per line to "-o" (or stdout). a FIFO is
+// reopened whenever its writer goes away, so any number of clients can feed jobs into it one after the other.
+void run_daemon_stream(const arguments& args) {
+    const bool from_stdin = std::strcmp(args.daemon_source, "-") == 0;
+    struct stat source_stat{};
+    const bool from_fifo = !from_stdin && stat(args.daemon_source, &source_stat) == 0 && S_ISFIFO(source_stat.st_mode);
+
+    std::ofstream output_file;
+    if (args.json_output)
+        output_file.open(args.json_output);
+    std::ostream& output = args.json_output ? output_file : std::cout;
+    std::mutex output_mutex;
+
+    daemon_state state;
+    state.cache.emplace(ResultCache::default_capacity, args.cache_dir ? std::optional<std::string>(args.cache_dir) : std::nullopt);
+    ThreadPool pool(args.daemon_jobs);
+    do {
+        std::ifstream input_file;
+        if (!from_stdin) {
+            input_file.open(args.daemon_source);
+            if (!input_file)
+                throw std::runtime_error(fmt::format("cannot open {}", args.daemon_source));
+        }
+        std::istream& input = from_stdin ? std::cin : input_file;
+
+        std::string line;
+        while (!stop_requested && std::getline(input, line)) {
+            if (line.find_first_not_of(" \t\r") == std::string::npos)
+                continue;
+            pool.submit([&args, &state, &output, &output_mutex, line] {
+                nlohmann::json result;
+                try {
+                    const auto job = nlohmann::json::parse(line);
+                    result = solve_job(job.value("job_id", nlohmann::json()), job, args, state);
+                } catch (std::exception& ex) {
+                    result = nlohmann::json::object({{"options", {{"success", false}, {"error", ex.what()}}}});
+                }
+                std::lock_guard lock(output_mutex);
+                output << result.dump() << std::endl;
+            });
+        }
+    } while (from_fifo && !stop_requested);
+}
+
+int run_daemon(const arguments& args) {
+    try {
+        if (std::string_view(args.daemon_source).starts_with("http://"))
+            run_daemon_http(args);
+        else
+            run_daemon_stream(args);
+    } catch (std::exception& ex) {
+        fmt::println(stderr, "Error: {}", ex.what());
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
 int main(int argc, char* const* argv) {
     arguments args;
     try {
@@ -181,37 +769,60 @@ int main(int argc, char* const* argv) {
         return EXIT_FAILURE;
     }
 
-    std::ifstream i(args.json_input);
-    nlohmann::json ji;
-    i >> ji;
+    if (args.daemon_source) {
+        std::signal(SIGINT, signal_handler);
+        return run_daemon(args);
+    }
+
+    phase_time input_time;
+    std::vector<Student> students;
+    {
+        PhaseTimer timer(input_time);
+        std::ifstream i(args.json_input);
+        nlohmann::json ji;
+        i >> ji;
+        students = read_student_config(ji);
+    }
+
+    Plan plan(std::move(students));
+    plan.set_input_time(input_time);
 
-    Plan plan(read_student_config(ji));
+    if (args.json_hint) {
+        std::ifstream h(args.json_hint);
+        nlohmann::json jh;
+        h >> jh;
+        plan.set_hint(read_schedule_hint(jh));
+    }
 
     std::signal(SIGINT, signal_handler);
-    if (args.timeout) {
-        std::signal(SIGALRM, signal_handler);
-        alarm(args.timeout);
+
+    if constexpr (print_stats)
+        plan.set_progress_callback([](const Plan::incumbent& found) {
+            fmt::println("incumbent: objective {} (bound {}) after {:.3f}s", found.objective_value, found.best_objective_bound, found.time);
+        });
+
+    std::optional<ResultCache> cache;
+    if (args.cache_dir) {
+        cache.emplace(ResultCache::default_capacity, args.cache_dir);
+        plan.set_cache(&*cache);
     }
 
-    const struct solve_config cfg = {
-        .range_attempts = args.range_attempts,
-        .range_increment = args.range_increment,
-        .minimize_wishes_prio = true,
-        .minimize_holes = true,
-        .lunch_time_from_hour = 12,
-        .lunch_time_from_minute = 0,
-        .lunch_time_to_hour = 13,
-        .lunch_time_to_minute = 0,
-        .lunch_hole_neg_prio = 10,
-        .non_lunch_hole_prio = 150,
-        .allow_skip = false,
-        .skip_prio = 1000000,
-    };
+    const auto cfg = make_solve_config(args);
 
-    const bool success = plan.schedule(cfg);
+    // solved on a thread of its own, so that an interrupt is passed on while the solver runs
+    auto handle = plan.schedule_async(cfg);
+    while (!handle.wait_for(std::chrono::milliseconds(100)))
+        if (stop_requested)
+            handle.cancel();
+    const bool success = handle.get();
 
     if (!success) {
         fmt::println("could not create plan");
+        if (!plan.is_feasible()) {
+            fmt::println("at least {} student(s) cannot be scheduled; these compete for too few slots:", plan.get_min_skipped());
+            for (const auto student : plan.get_conflicting())
+                fmt::println("  {} ({})", student->get_name(), student->get_id());
+        }
         return EXIT_FAILURE;
     }
 
@@ -220,10 +831,11 @@ int main(int argc, char* const* argv) {
 
     if (args.json_output) {
         std::ofstream o(args.json_output);
-        nlohmann::json jo = export_schedult_result(result, skipped, args);
+        nlohmann::json jo = export_schedult_result(plan, result, skipped, args);
         o << jo.dump(4) << std::endl;
     } else {
-        print_schedult_result(result, skipped);
+        print_schedult_result(plan, result, skipped);
+        print_schedult_alternatives(plan);
     }
 
     return EXIT_SUCCESS;
@@ -23,6 +23,7 @@ module = Extension(
     depends = HEADER,
     define_macros = [
         ("OR_PROTO_DLL", ""), # needed for v9.12
+        ("NDEBUG", None), # fast build mode, see config.hpp
     ],
     extra_compile_args=[
         "-std=c++20",
@@ -1,6 +1,8 @@
 #define PY_SSIZE_T_CLEAN
 #include <Python.h>
 #define PLAN_PY
+#include <chrono>
+#include <deque>
 #include "plan.hpp"
 
 static PyStructSequence_Field studentplanner_result_fields[] = {
@@ -23,6 +25,56 @@ static PyStructSequence_Desc studentplanner_result_desc = {
 
 static PyTypeObject* result_type = nullptr;
 
+// a flag which another thread can raise to stop a running solve; the solve then returns the best schedule so far
+struct CancelTokenObject {
+    PyObject_HEAD
+    std::atomic<bool> cancelled;
+};
+
+static PyObject* cancel_token_new(PyTypeObject* type, PyObject*, PyObject*) {
+    auto self = reinterpret_cast<CancelTokenObject*>(type->tp_alloc(type, 0));
+    if (self)
+        new (&self->cancelled) std::atomic<bool>(false);
+    return reinterpret_cast<PyObject*>(self);
+}
+
+static PyObject* cancel_token_cancel(PyObject* self, PyObject*) {
+    reinterpret_cast<CancelTokenObject*>(self)->cancelled = true;
+    Py_RETURN_NONE;
+}
+
+static PyObject* cancel_token_get_cancelled(PyObject* self, void*) {
+    return PyBool_FromLong(reinterpret_cast<CancelTokenObject*>(self)->cancelled);
+}
+
+static PyMethodDef cancel_token_methods[] = {
+    {"cancel", cancel_token_cancel, METH_NOARGS, "stop the solves using this token"},
+    {nullptr}
+};
+
+static PyGetSetDef cancel_token_getset[] = {
+    {"cancelled", cancel_token_get_cancelled, nullptr, "whether cancel() was called", nullptr},
+    {nullptr}
+};
+
+static PyType_Slot cancel_token_slots[] = {
+    {Py_tp_new, (void*) cancel_token_new},
+    {Py_tp_methods, cancel_token_methods},
+    {Py_tp_getset, cancel_token_getset},
+    {Py_tp_doc, (void*) "cancellation token which can be passed to solve() and triggered from another thread"},
+    {0, nullptr}
+};
+
+static PyType_Spec cancel_token_spec = {
+    "studentplanner.CancelToken",
+    sizeof(CancelTokenObject),
+    0,
+    Py_TPFLAGS_DEFAULT,
+    cancel_token_slots
+};
+
+static PyTypeObject* cancel_token_type = nullptr;
+
 struct PyObjectGuard {
     PyObjectGuard() {}
     PyObjectGuard(PyObject* obj) : obj{obj} {}
@@ -65,6 +117,31 @@ static PyObject* getattr_list(PyObject* obj, const char* attr) {
     return obj_attr;
 }
 
+// "student_prio" is the position in the input, 1 = first
+static Student read_student(PyObject* py_obj_student, unsigned student_prio) {
+    const auto id = getattr_unsigned_long(py_obj_student, "id");
+    const auto name = getattr_string(py_obj_student, "name");
+    const auto lesson_duration = getattr_unsigned_long(py_obj_student, "lesson_duration");
+
+    Student student(id, name, lesson_duration, student_prio);
+
+    student.py_obj_name = PyObject_GetAttrString(py_obj_student, "name");
+
+    PyObjectGuard py_obj_availabilies = getattr_list(py_obj_student, "availabilities");
+    const auto availabilities_count = PyList_Size(py_obj_availabilies);
+    for (Py_ssize_t availabilities_index{0}; availabilities_index < availabilities_count; ++availabilities_index) {
+        PyObject* py_obj_availability = PyList_GetItem(py_obj_availabilies, availabilities_index); // Borrowed reference
+        const auto day         = parse_day(getattr_string(py_obj_availability, "day"));
+        const auto from_hour   = getattr_unsigned_long(py_obj_availability, "from_hour");
+        const auto from_minute = getattr_unsigned_long(py_obj_availability, "from_minute");
+        const auto to_hour     = getattr_unsigned_long(py_obj_availability, "to_hour");
+        const auto to_minute   = getattr_unsigned_long(py_obj_availability, "to_minute");
+        student.add_availability(Time(day, from_hour, from_minute), Time(day, to_hour, to_minute));
+    }
+
+    return student;
+}
+
 static std::vector<Student> read_student_config(PyObject* py_list_students) {
     const auto students_count = PyList_Size(py_list_students);
     std::vector<Student> students;
@@ -74,32 +151,44 @@ static std::vector<Student> read_student_config(PyObject* py_list_students) {
         PyObject* py_obj_student = PyList_GetItem(py_list_students, students_index); // Borrowed reference
         if (!py_obj_student)
             throw std::runtime_error("could not retrieve student from list");
+        students.push_back(read_student(py_obj_student, students_index + 1));
+    }
 
-        const auto id = getattr_unsigned_long(py_obj_student, "id");
-        const auto name = getattr_string(py_obj_student, "name");
-        const auto lesson_duration = getattr_unsigned_long(py_obj_student, "lesson_duration");
-        const unsigned student_prio = students_index + 1;
-
-        Student student(id, name, lesson_duration, student_prio);
-
-        student.py_obj_name = PyObject_GetAttrString(py_obj_student, "name");
-
-        PyObjectGuard py_obj_availabilies = getattr_list(py_obj_student, "availabilities");
-        const auto availabilities_count = PyList_Size(py_obj_availabilies);
-        for (Py_ssize_t availabilities_index{0}; availabilities_index < availabilities_count; ++availabilities_index) {
-            PyObject* py_obj_availability = PyList_GetItem(py_obj_availabilies, availabilities_index); // Borrowed reference
-            const auto day         = parse_day(getattr_string(py_obj_availability, "day"));
-            const auto from_hour   = getattr_unsigned_long(py_obj_availability, "from_hour");
-            const auto from_minute = getattr_unsigned_long(py_obj_availability, "from_minute");
-            const auto to_hour     = getattr_unsigned_long(py_obj_availability, "to_hour");
-            const auto to_minute   = getattr_unsigned_long(py_obj_availability, "to_minute");
-            student.add_availability(Time(day, from_hour, from_minute), Time(day, to_hour, to_minute));
-        }
+    return students;
+}
 
-        students.push_back(student);
+// the day is either the 1-based number of a "result" or the name of the day
+static Day getattr_day(PyObject* obj, const char* attr) {
+    PyObjectGuard obj_attr = PyObject_GetAttrString(obj, attr);
+    if (!obj_attr)
+        throw std::runtime_error(fmt::format("attribute '{}' does not exist", attr));
+    if (PyLong_Check(obj_attr)) {
+        const auto day = getattr_unsigned_long(obj, attr);
+        if (day < 1 || day > day_names.size())
+            throw std::runtime_error(fmt::format("attribute '{}' is not a valid day number", attr));
+        return Day(day - 1);
     }
+    return parse_day(getattr_string(obj, attr));
+}
 
-    return students;
+static std::vector<Plan::schedule_hint> read_schedule_hint(PyObject* py_list_hint) {
+    if (!PyList_Check(py_list_hint))
+        throw std::runtime_error("hint is not a list");
+
+    const auto hint_count = PyList_Size(py_list_hint);
+    std::vector<Plan::schedule_hint> hint;
+    hint.reserve(hint_count);
+
+    for (Py_ssize_t hint_index{0}; hint_index < hint_count; ++hint_index) {
+        PyObject* py_obj_hint = PyList_GetItem(py_list_hint, hint_index); // Borrowed reference
+        const auto id          = getattr_unsigned_long(py_obj_hint, "id");
+        const auto day         = getattr_day(py_obj_hint, "day");
+        const auto from_hour   = getattr_unsigned_long(py_obj_hint, "from_hour");
+        const auto from_minute = getattr_unsigned_long(py_obj_hint, "from_minute");
+        hint.emplace_back(id, Time(day, from_hour, from_minute));
+    }
+
+    return hint;
 }
 
 static PyObject* export_schedult_result(const std::vector<Plan::schedule_result>& result) {
@@ -110,7 +199,7 @@ static PyObject* export_schedult_result(const std::vector<Plan::schedule_result>
         PyStructSequence_SetItem(result_tuple, 0, PyLong_FromLong(student_result.student->get_id()));
 
         PyObject* name = student_result.student->py_obj_name;
-        //Py_IncRef(name);
+        Py_IncRef(name);
         PyStructSequence_SetItem(result_tuple, 1, name);
 
         Day day = student_result.start.get_day();
@@ -136,7 +225,145 @@ static PyObject* export_schedult_skipped(const std::vector<const Student*>& skip
     return result_list;
 }
 
-static PyObject* studentplanner_solve(PyObject* self, PyObject* args, PyObject* keywds) {
+static PyObject* export_statistics(const solve_statistics& statistics) {
+    PyObject* py_dict_phases = PyDict_New();
+    for (size_t phase{}; phase < phase_names.size(); ++phase) {
+        PyObjectGuard py_dict_phase = Py_BuildValue("{s:d,s:d}",
+            "wall", statistics.phases[phase].wall,
+            "cpu", statistics.phases[phase].cpu);
+        PyDict_SetItemString(py_dict_phases, phase_names[phase], py_dict_phase);
+    }
+
+    PyObject* py_dict_constraints = PyDict_New();
+    for (size_t family{}; family < constraint_family_names.size(); ++family) {
+        PyObjectGuard py_count = PyLong_FromLongLong(statistics.constraints[family]);
+        PyDict_SetItemString(py_dict_constraints, constraint_family_names[family], py_count);
+    }
+
+    PyObject* py_list_stages = PyList_New(statistics.stages.size());
+    for (size_t stage_index{}; stage_index < statistics.stages.size(); ++stage_index) {
+        const auto& stage = statistics.stages[stage_index];
+        PyList_SetItem(py_list_stages, stage_index, Py_BuildValue("{s:s,s:O,s:d,s:d,s:d,s:d}",
+            "objective", objective_names.at(unsigned(stage.objective)).c_str(),
+            "optimal", stage.optimal ? Py_True : Py_False,
+            "objective_value", stage.objective_value,
+            "best_objective_bound", stage.best_objective_bound,
+            "wall", stage.time.wall,
+            "cpu", stage.time.cpu));
+    }
+
+    PyObject* py_list_trace = PyList_New(statistics.trace.size());
+    for (size_t point{}; point < statistics.trace.size(); ++point)
+        PyList_SetItem(py_list_trace, point, Py_BuildValue("(dd)", statistics.trace[point].time, statistics.trace[point].objective));
+
+    return Py_BuildValue("{s:N,s:I,s:L,s:L,s:N,s:L,s:L,s:I,s:I,s:I,s:I,s:d,s:d,s:N,s:N}",
+        "phases", py_dict_phases,
+        "models", statistics.models,
+        "variables", (long long) statistics.variables,
+        "model_bytes", (long long) statistics.model_bytes,
+        "constraints", py_dict_constraints,
+        "conflicts", (long long) statistics.conflicts,
+        "branches", (long long) statistics.branches,
+        "symmetry_classes", statistics.symmetry_classes,
+        "symmetric_students", statistics.symmetric_students,
+        "cache_hits", statistics.cache_hits,
+        "cache_misses", statistics.cache_misses,
+        "best_objective_bound", statistics.best_objective_bound,
+        "gap", statistics.gap,
+        "stages", py_list_stages,
+        "trace", py_list_trace);
+}
+
+static PyObject* export_schedule_info(const Plan& plan) {
+    const auto& alternatives = plan.get_alternatives();
+    PyObject* py_list_alternatives = PyList_New(alternatives.size());
+    for (size_t alternative_index{}; alternative_index < alternatives.size(); ++alternative_index) {
+        const auto& alternative = alternatives[alternative_index];
+        PyList_SetItem(py_list_alternatives, alternative_index, Py_BuildValue("{s:d,s:O,s:N,s:N}",
+            "objective", alternative.objective_value,
+            "optimal", alternative.optimal ? Py_True : Py_False,
+            "schedule", export_schedult_result(alternative.result),
+            "skipped", export_schedult_skipped(alternative.skipped)));
+    }
+
+    return Py_BuildValue("{s:s,s:O,s:d,s:s,s:N,s:N}",
+        "status", plan.get_status_name().c_str(),
+        "optimal", plan.is_optimal() ? Py_True : Py_False,
+        "gap", plan.get_gap(),
+        "engine", plan.get_engine_name(),
+        "alternatives", py_list_alternatives,
+        "statistics", export_statistics(plan.get_statistics()));
+}
+
+// set by "set_cache"; every job keeps the cache it started with, so replacing it does not disturb running solves
+static std::shared_ptr<ResultCache> result_cache;
+
+// a solve with everything converted to C++ data, so that it can run without holding the GIL. every student of
+// the plan holds a reference to its name.
+struct solve_job {
+    solve_job() {}
+    solve_job(const solve_job&) = delete;
+    solve_job& operator=(const solve_job&) = delete;
+    ~solve_job() {
+        Py_DecRef(cancel_token);
+        Py_DecRef(on_solution);
+        if (plan)
+            for (const auto& student : plan->get_students())
+                Py_DecRef(student.py_obj_name);
+    }
+
+    std::optional<Plan> plan;
+    struct solve_config cfg;
+    PyObject* cancel_token = nullptr;
+    PyObject* on_solution = nullptr;
+    std::shared_ptr<ResultCache> cache;
+
+    bool success{false};
+    std::string error;
+    double queue_time{};
+    double solve_time{};
+};
+
+// the token has to stay alive while the solver looks at it
+static void set_cancel_token(solve_job& job, PyObject* py_cancel_token) {
+    Py_IncRef(py_cancel_token);
+    job.cancel_token = py_cancel_token;
+    job.plan->set_stop_flag(&reinterpret_cast<CancelTokenObject*>(py_cancel_token)->cancelled);
+}
+
+// "on_solution" is called with a dict of every improving schedule, from the solver's threads. an exception it
+// raises is reported as unraisable and does not stop the solve.
+static void set_on_solution(solve_job& job, PyObject* py_on_solution) {
+    Py_IncRef(py_on_solution);
+    job.on_solution = py_on_solution;
+    job.plan->set_progress_callback([py_on_solution](const Plan::incumbent& found) {
+        const auto gil = PyGILState_Ensure();
+        {
+            PyObjectGuard py_dict_incumbent = Py_BuildValue("{s:d,s:d,s:d,s:N,s:N}",
+                "objective", found.objective_value,
+                "best_objective_bound", found.best_objective_bound,
+                "time", found.time,
+                "schedule", export_schedult_result(found.result),
+                "skipped", export_schedult_skipped(found.skipped));
+            PyObjectGuard py_result = PyObject_CallFunctionObjArgs(py_on_solution, (PyObject*) py_dict_incumbent, nullptr);
+            if (!py_result)
+                PyErr_WriteUnraisable(py_on_solution);
+        }
+        PyGILState_Release(gil);
+    });
+}
+
+// returns false with a Python exception set if "py_on_solution" is neither None nor callable
+static bool check_on_solution(PyObject* py_on_solution) {
+    if (py_on_solution && py_on_solution != Py_None && !PyCallable_Check(py_on_solution)) {
+        PyErr_SetString(PyExc_TypeError, "\"on_solution\" needs to be callable");
+        return false;
+    }
+    return true;
+}
+
+// parses the arguments of "solve" into "job". returns false with a Python exception set if that fails.
+static bool parse_solve_job(PyObject* args, PyObject* keywds, solve_job& job) {
     static const char* kwlist[] = {
         "students",
         "range_attempts",
@@ -151,12 +378,47 @@ static PyObject* studentplanner_solve(PyObject* self, PyObject* args, PyObject*
         "non_lunch_hole_prio",
         "allow_skip",
         "skip_prio",
+        "conflict_encoding",
+        "hole_encoding",
+        "time_limit",
+        "relative_gap_limit",
+        "hint",
+        "repair_hint",
+        "decompose",
+        "num_workers",
+        "precheck",
+        "mode",
+        "objective_order",
+        "time_granularity",
+        "coarse_granularity",
+        "model_encoding",
+        "alternatives",
+        "alternative_distance",
+        "break_symmetry",
+        "candidate_mode",
+        "on_solution",
+        "cancel",
         nullptr
     };
     PyObject* py_list_students;
-    struct solve_config cfg = {
+    const char* conflict_encoding = nullptr;
+    const char* hole_encoding = nullptr;
+    const char* solve_mode = nullptr;
+    const char* objective_order = nullptr;
+    const char* model_encoding = nullptr;
+    const char* candidate_mode = nullptr;
+    PyObject* py_list_hint = nullptr;
+    PyObject* py_on_solution = nullptr;
+    PyObject* py_cancel_token = nullptr;
+    int repair_hint = false;
+    int decompose = true;
+    int precheck = true;
+    int break_symmetry = true;
+    auto& cfg = job.cfg;
+    cfg = {
         .range_attempts = default_range_attempts,
         .range_increment = default_range_increment,
+        .candidate_mode = CandidateMode::UNIFORM,
         .minimize_wishes_prio = true,
         .minimize_holes = true,
         .lunch_time_from_hour = 12,
@@ -167,9 +429,25 @@ static PyObject* studentplanner_solve(PyObject* self, PyObject* args, PyObject*
         .non_lunch_hole_prio = 150,
         .allow_skip = false,
         .skip_prio = 1000000,
+        .conflict_encoding = ConflictEncoding::AT_MOST_ONE,
+        .hole_encoding = HoleEncoding::CHAIN,
+        .max_time_in_seconds = 0,
+        .relative_gap_limit = 0,
+        .repair_hint = false,
+        .decompose = true,
+        .num_workers = 0,
+        .precheck = true,
+        .break_symmetry = true,
+        .solve_mode = SolveMode::EXACT,
+        .objective_order = {},
+        .time_granularity = default_time_granularity,
+        .coarse_granularity = 0,
+        .model_encoding = ModelEncoding::BOOLEAN,
+        .alternatives = 0,
+        .alternative_distance = 1,
     };
 
-    if (!PyArg_ParseTupleAndKeywords(args, keywds, "O!|IIppIIIIIIpI", (char**) kwlist,
+    if (!PyArg_ParseTupleAndKeywords(args, keywds, "O!|IIppIIIIIIpIssddOppIpssIIsIIpsOO!", (char**) kwlist,
         &PyList_Type, &py_list_students,
         &cfg.range_attempts,
         &cfg.range_increment,
@@ -182,23 +460,485 @@ static PyObject* studentplanner_solve(PyObject* self, PyObject* args, PyObject*
         &cfg.lunch_hole_neg_prio,
         &cfg.non_lunch_hole_prio,
         &cfg.allow_skip,
-        &cfg.skip_prio))
+        &cfg.skip_prio,
+        &conflict_encoding,
+        &hole_encoding,
+        &cfg.max_time_in_seconds,
+        &cfg.relative_gap_limit,
+        &py_list_hint,
+        &repair_hint,
+        &decompose,
+        &cfg.num_workers,
+        &precheck,
+        &solve_mode,
+        &objective_order,
+        &cfg.time_granularity,
+        &cfg.coarse_granularity,
+        &model_encoding,
+        &cfg.alternatives,
+        &cfg.alternative_distance,
+        &break_symmetry,
+        &candidate_mode,
+        &py_on_solution,
+        cancel_token_type, &py_cancel_token))
+        return false;
+    if (!check_on_solution(py_on_solution))
+        return false;
+
+    cfg.repair_hint = repair_hint;
+    cfg.decompose = decompose;
+    cfg.precheck = precheck;
+    cfg.break_symmetry = break_symmetry;
+    try {
+        if (conflict_encoding)
+            cfg.conflict_encoding = parse_conflict_encoding(conflict_encoding);
+        if (hole_encoding)
+            cfg.hole_encoding = parse_hole_encoding(hole_encoding);
+        if (solve_mode)
+            cfg.solve_mode = parse_solve_mode(solve_mode);
+        if (model_encoding)
+            cfg.model_encoding = parse_model_encoding(model_encoding);
+        if (candidate_mode)
+            cfg.candidate_mode = parse_candidate_mode(candidate_mode);
+        if (objective_order && *objective_order)
+            cfg.objective_order = parse_objective_order(objective_order);
+        validate_time_granularity(cfg.time_granularity);
+        validate_coarse_granularity(cfg.coarse_granularity, cfg.time_granularity);
+        validate_alternative_distance(cfg.alternative_distance);
+    } catch (std::runtime_error& ex) {
+        PyErr_SetString(PyExc_ValueError, ex.what());
+        return false;
+    }
+
+    try {
+        phase_time input_time;
+        std::vector<Student> students;
+        {
+            PhaseTimer timer(input_time);
+            students = read_student_config(py_list_students);
+        }
+        job.plan.emplace(std::move(students));
+        job.plan->set_input_time(input_time);
+        job.cache = result_cache;
+        job.plan->set_cache(job.cache.get());
+        if (py_list_hint && py_list_hint != Py_None)
+            job.plan->set_hint(read_schedule_hint(py_list_hint));
+    } catch (std::runtime_error& ex) {
+        PyErr_SetString(PyExc_ValueError, ex.what());
+        return false;
+    }
+
+    if (py_cancel_token)
+        set_cancel_token(job, py_cancel_token);
+    if (py_on_solution && py_on_solution != Py_None)
+        set_on_solution(job, py_on_solution);
+
+    return true;
+}
+
+// runs without the GIL
+static void run_solve_job(solve_job& job) {
+    const auto start = std::chrono::steady_clock::now();
+    try {
+        job.success = job.plan->schedule(job.cfg);
+    } catch (std::exception& ex) {
+        job.error = ex.what();
+    }
+    job.solve_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// why the job did not produce a schedule, or an empty string if it did
+static std::string solve_job_error(const solve_job& job) {
+    if (!job.error.empty())
+        return job.error;
+    if (job.success)
+        return {};
+    const auto& plan = *job.plan;
+    if (plan.is_feasible())
+        return "could not create plan";
+
+    std::string conflicting;
+    for (const auto student : plan.get_conflicting())
+        conflicting += fmt::format("{}{} ({})", conflicting.empty() ? "" : ", ", student->get_name(), student->get_id());
+    return fmt::format("could not create plan: at least {} student(s) cannot be scheduled, competing: {}",
+        plan.get_min_skipped(), conflicting);
+}
+
+// the (schedule, skipped, info) tuple of "solve", or nullptr with a Python exception set
+static PyObject* export_solve_result(const solve_job& job) {
+    const auto error = solve_job_error(job);
+    if (!error.empty()) {
+        PyErr_SetString(PyExc_RuntimeError, error.c_str());
         return nullptr;
+    }
+
+    const auto& plan = *job.plan;
+    return Py_BuildValue("(NNN)", export_schedult_result(plan.get_result()), export_schedult_skipped(plan.get_skipped()), export_schedule_info(plan));
+}
 
-    Plan plan(read_student_config(py_list_students));
-    const bool success = plan.schedule(cfg);
-    if (!success) {
-        PyErr_SetString(PyExc_RuntimeError,  "could not create plan");
+static PyObject* studentplanner_solve(PyObject* self, PyObject* args, PyObject* keywds) {
+    solve_job job;
+    if (!parse_solve_job(args, keywds, job))
+        return nullptr;
+
+    Py_BEGIN_ALLOW_THREADS
+    run_solve_job(job);
+    Py_END_ALLOW_THREADS
+
+    return export_solve_result(job);
+}
+
+static PyObject* export_batch_result(const solve_job& job) {
+    const auto error = solve_job_error(job);
+    if (!error.empty())
+        return Py_BuildValue("{s:O,s:O,s:N,s:s,s:d,s:d}",
+            "schedule", Py_None,
+            "skipped", Py_None,
+            "info", export_schedule_info(*job.plan),
+            "error", error.c_str(),
+            "queue_time", job.queue_time,
+            "solve_time", job.solve_time);
+
+    const auto& plan = *job.plan;
+    return Py_BuildValue("{s:N,s:N,s:N,s:O,s:d,s:d}",
+        "schedule", export_schedult_result(plan.get_result()),
+        "skipped", export_schedult_skipped(plan.get_skipped()),
+        "info", export_schedule_info(plan),
+        "error", Py_None,
+        "queue_time", job.queue_time,
+        "solve_time", job.solve_time);
+}
+
+// every job is a dict with the keyword arguments of "solve". "max_parallel" jobs run at the same time, each with
+// "threads_per_job" solver workers (unless the job sets "num_workers" itself); by default the cores are split evenly.
+// the solve CPU time in the statistics of a job is the one of the whole process, so it includes the concurrent jobs.
+static PyObject* studentplanner_solve_batch(PyObject* self, PyObject* args, PyObject* keywds) {
+    static const char* kwlist[] = {
+        "jobs",
+        "max_parallel",
+        "threads_per_job",
+        nullptr
+    };
+    PyObject* py_list_jobs;
+    unsigned max_parallel = 0;
+    unsigned threads_per_job = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, keywds, "O!|II", (char**) kwlist,
+        &PyList_Type, &py_list_jobs,
+        &max_parallel,
+        &threads_per_job))
+        return nullptr;
+
+    const auto jobs_count = PyList_Size(py_list_jobs);
+    PyObjectGuard no_args = PyTuple_New(0);
+    std::deque<solve_job> jobs;
+    for (Py_ssize_t jobs_index{0}; jobs_index < jobs_count; ++jobs_index) {
+        PyObject* py_dict_job = PyList_GetItem(py_list_jobs, jobs_index); // Borrowed reference
+        if (!PyDict_Check(py_dict_job)) {
+            PyErr_Format(PyExc_TypeError, "job %zd is not a dict", jobs_index);
+            return nullptr;
+        }
+        if (!parse_solve_job(no_args, py_dict_job, jobs.emplace_back()))
+            return nullptr;
+    }
+    if (jobs.empty())
+        return PyList_New(0);
+
+    const unsigned hardware_threads = std::max(1u, std::thread::hardware_concurrency());
+    if (!max_parallel)
+        max_parallel = threads_per_job ? hardware_threads / threads_per_job : hardware_threads;
+    max_parallel = std::clamp<unsigned>(max_parallel, 1, jobs.size());
+    if (!threads_per_job)
+        threads_per_job = std::max(1u, hardware_threads / max_parallel);
+    for (auto& job : jobs)
+        if (!job.cfg.num_workers)
+            job.cfg.num_workers = threads_per_job;
+
+    Py_BEGIN_ALLOW_THREADS
+    {
+        const auto submitted = std::chrono::steady_clock::now();
+        ThreadPool pool(max_parallel);
+        for (auto& job : jobs) {
+            pool.submit([&job, submitted] {
+                job.queue_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - submitted).count();
+                run_solve_job(job);
+            });
+        }
+    }
+    Py_END_ALLOW_THREADS
+
+    PyObject* result_list = PyList_New(jobs.size());
+    Py_ssize_t result_list_index{0};
+    for (const auto& job : jobs)
+        PyList_SetItem(result_list, result_list_index++, export_batch_result(job));
+    return result_list;
+}
+
+// capacity 0 switches the cache off
+static PyObject* studentplanner_set_cache(PyObject* self, PyObject* args, PyObject* keywds) {
+    static const char* kwlist[] = {
+        "capacity",
+        "directory",
+        nullptr
+    };
+    Py_ssize_t capacity = ResultCache::default_capacity;
+    const char* directory = nullptr;
+
+    if (!PyArg_ParseTupleAndKeywords(args, keywds, "|nz", (char**) kwlist,
+        &capacity,
+        &directory))
+        return nullptr;
+
+    if (capacity < 0) {
+        PyErr_SetString(PyExc_ValueError, "the capacity cannot be negative");
         return nullptr;
     }
+    try {
+        result_cache = capacity ? std::make_shared<ResultCache>(capacity, directory ? std::optional<std::string>(directory) : std::nullopt) : nullptr;
+    } catch (std::exception& ex) {
+        PyErr_SetString(PyExc_OSError, ex.what());
+        return nullptr;
+    }
+    Py_RETURN_NONE;
+}
 
-    const auto result = plan.get_result();
-    const auto skipped = plan.get_skipped();
-    return PyTuple_Pack(2, export_schedult_result(result), export_schedult_skipped(skipped));
+static PyObject* studentplanner_cache_info(PyObject* self, PyObject* args) {
+    if (!result_cache)
+        Py_RETURN_NONE;
+    return Py_BuildValue("{s:K,s:K,s:n}",
+        "hits", (unsigned long long) result_cache->get_hits(),
+        "misses", (unsigned long long) result_cache->get_misses(),
+        "size", (Py_ssize_t) result_cache->get_size());
 }
 
+// students, settings and the last schedule, kept between solves for asking many "what if" questions in a row.
+// a student keeps its priority when others are removed, so that the components which did not change hash the
+// same as before and come from the cache; only the components with a changed student are solved again.
+struct PlannerObject {
+    PyObject_HEAD
+    std::vector<Student> students; // every one holds a reference to its name
+    struct solve_config cfg;
+    unsigned next_prio;
+    std::vector<Plan::schedule_hint> hint;
+    std::shared_ptr<ResultCache> cache;
+};
+
+static PlannerObject* as_planner(PyObject* self) { return reinterpret_cast<PlannerObject*>(self); }
+
+static void planner_clear_students(PlannerObject* self) {
+    for (const auto& student : self->students)
+        Py_DecRef(student.py_obj_name);
+    self->students.clear();
+}
+
+static std::vector<Student>::iterator planner_find(PlannerObject* self, unsigned id) {
+    return std::find_if(self->students.begin(), self->students.end(), [id](const Student& student) { return student.get_id() == id; });
+}
+
+static PyObject* planner_new(PyTypeObject* type, PyObject*, PyObject*) {
+    auto self = reinterpret_cast<PlannerObject*>(type->tp_alloc(type, 0));
+    if (self) {
+        new (&self->students) std::vector<Student>();
+        new (&self->cfg) solve_config();
+        self->next_prio = 1;
+        new (&self->hint) std::vector<Plan::schedule_hint>();
+        new (&self->cache) std::shared_ptr<ResultCache>();
+    }
+    return reinterpret_cast<PyObject*>(self);
+}
+
+static void planner_dealloc(PyObject* py_self) {
+    auto self = as_planner(py_self);
+    PyTypeObject* type = Py_TYPE(py_self);
+    planner_clear_students(self);
+    self->students.~vector();
+    self->cfg.~solve_config();
+    self->hint.~vector();
+    self->cache.~shared_ptr();
+    type->tp_free(py_self);
+    Py_DecRef(reinterpret_cast<PyObject*>(type));
+}
+
+// takes the arguments of "solve" except "cancel" and "on_solution", which belong to "Planner.solve"
+static int planner_init(PyObject* py_self, PyObject* args, PyObject* keywds) {
+    auto self = as_planner(py_self);
+    solve_job job;
+    if (!parse_solve_job(args, keywds, job))
+        return -1;
+    if (job.cancel_token) {
+        PyErr_SetString(PyExc_TypeError, "\"cancel\" is an argument of Planner.solve()");
+        return -1;
+    }
+    if (job.on_solution) {
+        PyErr_SetString(PyExc_TypeError, "\"on_solution\" is an argument of Planner.solve()");
+        return -1;
+    }
+
+    planner_clear_students(self);
+    for (const auto& student : job.plan->get_students()) {
+        if (planner_find(self, student.get_id()) != self->students.end()) {
+            PyErr_Format(PyExc_ValueError, "student %u appears twice", student.get_id());
+            return -1;
+        }
+        Py_IncRef(student.py_obj_name);
+        self->students.push_back(student);
+    }
+    self->cfg = job.cfg;
+    self->next_prio = self->students.size() + 1;
+    self->hint = job.plan->get_hint();
+    // without a cache from "set_cache", the planner keeps one of its own
+    self->cache = job.cache ? job.cache : std::make_shared<ResultCache>();
+    return 0;
+}
+
+// the new student is placed behind all others
+static PyObject* planner_add_student(PyObject* py_self, PyObject* py_obj_student) {
+    auto self = as_planner(py_self);
+    try {
+        auto student = read_student(py_obj_student, self->next_prio);
+        if (planner_find(self, student.get_id()) != self->students.end()) {
+            Py_DecRef(student.py_obj_name);
+            PyErr_Format(PyExc_ValueError, "student %u already exists", student.get_id());
+            return nullptr;
+        }
+        self->students.push_back(std::move(student));
+    } catch (std::runtime_error& ex) {
+        PyErr_SetString(PyExc_ValueError, ex.what());
+        return nullptr;
+    }
+    ++self->next_prio;
+    Py_RETURN_NONE;
+}
+
+static PyObject* planner_remove_student(PyObject* py_self, PyObject* py_id) {
+    auto self = as_planner(py_self);
+    const auto id = PyLong_AsUnsignedLong(py_id);
+    if (id == (unsigned long)-1 && PyErr_Occurred())
+        return nullptr;
+    const auto it = planner_find(self, id);
+    if (it == self->students.end()) {
+        PyErr_Format(PyExc_KeyError, "no student %lu", id);
+        return nullptr;
+    }
+    Py_DecRef(it->py_obj_name);
+    self->students.erase(it);
+    Py_RETURN_NONE;
+}
+
+// replaces the student with the same id, which keeps its position and priority
+static PyObject* planner_update_student(PyObject* py_self, PyObject* py_obj_student) {
+    auto self = as_planner(py_self);
+    try {
+        const auto id = getattr_unsigned_long(py_obj_student, "id");
+        const auto it = planner_find(self, id);
+        if (it == self->students.end()) {
+            PyErr_Format(PyExc_KeyError, "no student %lu", id);
+            return nullptr;
+        }
+        auto student = read_student(py_obj_student, it->get_student_prio());
+        Py_DecRef(it->py_obj_name);
+        *it = std::move(student);
+    } catch (std::runtime_error& ex) {
+        PyErr_SetString(PyExc_ValueError, ex.what());
+        return nullptr;
+    }
+    Py_RETURN_NONE;
+}
+
+// solves the current students, hinted with the last schedule. "time_limit" overrides the one of the constructor.
+static PyObject* planner_solve(PyObject* py_self, PyObject* args, PyObject* keywds) {
+    static const char* kwlist[] = {
+        "time_limit",
+        "on_solution",
+        "cancel",
+        nullptr
+    };
+    auto self = as_planner(py_self);
+    solve_job job;
+    job.cfg = self->cfg;
+    PyObject* py_on_solution = nullptr;
+    PyObject* py_cancel_token = nullptr;
+
+    if (!PyArg_ParseTupleAndKeywords(args, keywds, "|dOO!", (char**) kwlist,
+        &job.cfg.max_time_in_seconds,
+        &py_on_solution,
+        cancel_token_type, &py_cancel_token))
+        return nullptr;
+    if (!check_on_solution(py_on_solution))
+        return nullptr;
+
+    // the job works on copies, so the planner may be changed while it runs
+    for (const auto& student : self->students)
+        Py_IncRef(student.py_obj_name);
+    job.plan.emplace(std::vector<Student>(self->students));
+    job.plan->set_hint(std::vector<Plan::schedule_hint>(self->hint));
+    job.cache = self->cache;
+    job.plan->set_cache(job.cache.get());
+    if (py_cancel_token)
+        set_cancel_token(job, py_cancel_token);
+    if (py_on_solution && py_on_solution != Py_None)
+        set_on_solution(job, py_on_solution);
+
+    Py_BEGIN_ALLOW_THREADS
+    run_solve_job(job);
+    Py_END_ALLOW_THREADS
+
+    const auto& plan = *job.plan;
+    if (solve_job_error(job).empty()) {
+        self->hint.clear();
+        for (const auto& [start, end, student] : plan.get_result())
+            self->hint.emplace_back(student->get_id(), start);
+    }
+    return export_solve_result(job);
+}
+
+static PyObject* planner_get_student_ids(PyObject* py_self, void*) {
+    const auto& students = as_planner(py_self)->students;
+    PyObject* id_list = PyList_New(students.size());
+    Py_ssize_t id_list_index{0};
+    for (const auto& student : students)
+        PyList_SetItem(id_list, id_list_index++, PyLong_FromUnsignedLong(student.get_id()));
+    return id_list;
+}
+
+static PyMethodDef planner_methods[] = {
+    {"add_student", planner_add_student, METH_O, "add a student, behind all others"},
+    {"remove_student", planner_remove_student, METH_O, "remove the student with the given id"},
+    {"update_student", planner_update_student, METH_O, "replace the student with the same id, keeping its position"},
+    {"solve", (PyCFunction) planner_solve, METH_VARARGS | METH_KEYWORDS, "solve the current students, starting from the last schedule; returns the same as solve()"},
+    {nullptr}
+};
+
+static PyGetSetDef planner_getset[] = {
+    {"student_ids", planner_get_student_ids, nullptr, "ids of the students, in order", nullptr},
+    {nullptr}
+};
+
+static PyType_Slot planner_slots[] = {
+    {Py_tp_new, (void*) planner_new},
+    {Py_tp_init, (void*) planner_init},
+    {Py_tp_dealloc, (void*) planner_dealloc},
+    {Py_tp_methods, planner_methods},
+    {Py_tp_getset, planner_getset},
+    {Py_tp_doc, (void*) "students and settings (the arguments of solve()) kept across solves, which can be changed one student at a time"},
+    {0, nullptr}
+};
+
+static PyType_Spec planner_spec = {
+    "studentplanner.Planner",
+    sizeof(PlannerObject),
+    0,
+    Py_TPFLAGS_DEFAULT,
+    planner_slots
+};
+
+static PyTypeObject* planner_type = nullptr;
+
 static PyMethodDef StudentPlannerMethods[] = {
     {"solve", (PyCFunction) studentplanner_solve, METH_VARARGS | METH_KEYWORDS, "provide an optimal scheduling for the given constraints"},
+    {"solve_batch", (PyCFunction) studentplanner_solve_batch, METH_VARARGS | METH_KEYWORDS, "solve a list of jobs (dicts of solve() arguments) concurrently, returning one result dict per job"},
+    {"set_cache", (PyCFunction) studentplanner_set_cache, METH_VARARGS | METH_KEYWORDS, "keep optimal results of up to \"capacity\" inputs in memory (0 = off), and of all in \"directory\" if given"},
+    {"cache_info", studentplanner_cache_info, METH_NOARGS, "hits, misses and size of the result cache, None without one"},
     {nullptr}
 };
 
@@ -224,5 +964,15 @@ PyInit_studentplanner(void) {
         result_type = PyStructSequence_NewType(&studentplanner_result_desc);
     PyModule_AddObject(studentplanner_module, "result", (PyObject *) result_type);
 
+    if (!cancel_token_type)
+        cancel_token_type = (PyTypeObject *) PyType_FromSpec(&cancel_token_spec);
+    Py_IncRef((PyObject *) cancel_token_type);
+    PyModule_AddObject(studentplanner_module, "CancelToken", (PyObject *) cancel_token_type);
+
+    if (!planner_type)
+        planner_type = (PyTypeObject *) PyType_FromSpec(&planner_spec);
+    Py_IncRef((PyObject *) planner_type);
+    PyModule_AddObject(studentplanner_module, "Planner", (PyObject *) planner_type);
+
     return studentplanner_module;
 }
@@ -23,8 +23,8 @@ def test():
         availabilities = [Availability(**availability) for availability in student_j["availabilities"]]
         students.append(Student(student_j["id"], student_j["name"], student_j["lesson_duration"], availabilities))
 
-    s = solve(students)
-    print(s)
+    schedule, skipped, info = solve(students)
+    print(schedule, skipped, info)
 
 def main():
     gc.disable()